@@ -7,9 +7,9 @@
 #include <random>
 #include <cstring>
 #include <cmath>
+#include <cctype>
 #include <iostream>
-#include <sstream>
-#include <iomanip>
+#include <limits>
 
 namespace HyperLayer {
 
@@ -30,12 +30,414 @@ void secure_random_bytes(uint8_t* buffer, size_t len) {
 
 // Hash array'i string'e çevir
 std::string hash_to_string(const Hash256& hash) {
-    std::stringstream ss;
-    ss << std::hex << std::setfill('0');
-    for (auto byte : hash) {
-        ss << std::setw(2) << static_cast<int>(byte);
+    return HexHash(hash).str();
+}
+
+namespace {
+const char HEX_DIGITS[] = "0123456789abcdef";
+
+// Karakter -> nibble; geçersizse -1
+struct HexTable {
+    std::array<int8_t, 256> value;
+    
+    HexTable() {
+        value.fill(-1);
+        for (int i = 0; i < 10; ++i) {
+            value['0' + i] = static_cast<int8_t>(i);
+        }
+        for (int i = 0; i < 6; ++i) {
+            value['a' + i] = static_cast<int8_t>(10 + i);
+            value['A' + i] = static_cast<int8_t>(10 + i);
+        }
+    }
+};
+const HexTable HEX_TABLE;
+}
+
+void hex_encode(const uint8_t* data, size_t len, char* out) {
+    size_t i = 0;
+#if defined(__SSE2__)
+    // nibble + '0', 9'dan büyükse + ('a' - '0' - 10)
+    const __m128i low_mask = _mm_set1_epi8(0x0F);
+    const __m128i nine = _mm_set1_epi8(9);
+    const __m128i zero_char = _mm_set1_epi8('0');
+    const __m128i letter_gap = _mm_set1_epi8('a' - '0' - 10);
+    auto to_chars = [&](__m128i nibbles) {
+        __m128i letters = _mm_and_si128(_mm_cmpgt_epi8(nibbles, nine), letter_gap);
+        return _mm_add_epi8(_mm_add_epi8(nibbles, zero_char), letters);
+    };
+    for (; i + 16 <= len; i += 16) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        __m128i high = _mm_and_si128(_mm_srli_epi16(bytes, 4), low_mask);
+        __m128i low = _mm_and_si128(bytes, low_mask);
+        // Her bayt için önce yüksek nibble: hi0 lo0 hi1 lo1 ...
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 2 * i), to_chars(_mm_unpacklo_epi8(high, low)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 2 * i + 16), to_chars(_mm_unpackhi_epi8(high, low)));
+    }
+#endif
+    for (; i < len; ++i) {
+        out[2 * i] = HEX_DIGITS[data[i] >> 4];
+        out[2 * i + 1] = HEX_DIGITS[data[i] & 0x0F];
+    }
+}
+
+bool hex_decode(const char* hex, size_t len, uint8_t* out) {
+    if (len % 2 != 0) {
+        return false;
+    }
+    size_t i = 0;
+#if defined(__SSE2__)
+    // 16 karakter -> 8 bayt. Aralık dışı karakter (0x80 üstü dahil, işaretli
+    // karşılaştırmada negatif) hem rakam hem harf maskesinden düşer.
+    const __m128i case_bit = _mm_set1_epi8(0x20);
+    for (; i + 16 <= len; i += 16) {
+        __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(hex + i));
+        __m128i digit = _mm_sub_epi8(chars, _mm_set1_epi8('0'));
+        __m128i is_digit = _mm_and_si128(_mm_cmpgt_epi8(chars, _mm_set1_epi8('0' - 1)),
+                                         _mm_cmplt_epi8(chars, _mm_set1_epi8('9' + 1)));
+        __m128i lower = _mm_or_si128(chars, case_bit);
+        __m128i letter = _mm_sub_epi8(lower, _mm_set1_epi8('a' - 10));
+        __m128i is_letter = _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)),
+                                          _mm_cmplt_epi8(lower, _mm_set1_epi8('f' + 1)));
+        if (_mm_movemask_epi8(_mm_or_si128(is_digit, is_letter)) != 0xFFFF) {
+            return false;
+        }
+        __m128i nibbles = _mm_or_si128(_mm_and_si128(is_digit, digit), _mm_and_si128(is_letter, letter));
+        
+        // 16 bitlik şeritte düşük bayt yüksek nibble: (a << 4) | b
+        __m128i pairs = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(nibbles, _mm_set1_epi16(0x00FF)), 4),
+                                     _mm_srli_epi16(nibbles, 8));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(out + i / 2), _mm_packus_epi16(pairs, pairs));
+    }
+#endif
+    for (; i < len; i += 2) {
+        int high = HEX_TABLE.value[static_cast<uint8_t>(hex[i])];
+        int low = HEX_TABLE.value[static_cast<uint8_t>(hex[i + 1])];
+        if ((high | low) < 0) {
+            return false;
+        }
+        out[i / 2] = static_cast<uint8_t>(high << 4 | low);
+    }
+    return true;
+}
+
+bool HexHash::parse(std::string_view hex, Hash256& out) {
+    return hex.size() == 2 * out.size() && hex_decode(hex.data(), hex.size(), out.data());
+}
+
+std::ostream& operator<<(std::ostream& os, const HexHash& hex) {
+    return os << hex.view();
+}
+
+namespace {
+const char BASE64_DIGITS[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+int base64_value(char c) {
+    if (c >= 'A' && c <= 'Z') return c - 'A';
+    if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+    if (c >= '0' && c <= '9') return c - '0' + 52;
+    if (c == '+') return 62;
+    if (c == '/') return 63;
+    return -1;
+}
+
+size_t json_skip_ws(std::string_view text, size_t pos) {
+    while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\t' || text[pos] == '\n' || text[pos] == '\r')) {
+        ++pos;
+    }
+    return pos;
+}
+
+// pos'taki değerin hemen sonrası; biçim hatasında npos
+size_t json_skip_value(std::string_view text, size_t pos) {
+    const size_t npos = std::string_view::npos;
+    if (pos >= text.size()) {
+        return npos;
+    }
+    char c = text[pos];
+    if (c == '"') {
+        for (++pos; pos < text.size(); ++pos) {
+            if (text[pos] == '\\') {
+                ++pos;
+            } else if (text[pos] == '"') {
+                return pos + 1;
+            }
+        }
+        return npos;
+    }
+    if (c == '{' || c == '[') {
+        int depth = 0;
+        while (pos < text.size()) {
+            char ch = text[pos];
+            if (ch == '"') {
+                pos = json_skip_value(text, pos);
+                if (pos == npos) {
+                    return npos;
+                }
+                continue;
+            }
+            if (ch == '{' || ch == '[') {
+                ++depth;
+            } else if ((ch == '}' || ch == ']') && --depth == 0) {
+                return pos + 1;
+            }
+            ++pos;
+        }
+        return npos;
+    }
+    // Sayı ya da true/false/null
+    size_t start = pos;
+    while (pos < text.size() && (std::isalnum(static_cast<unsigned char>(text[pos])) ||
+                                 text[pos] == '-' || text[pos] == '+' || text[pos] == '.')) {
+        ++pos;
+    }
+    return pos == start ? npos : pos;
+}
+
+// Dizi ve nesne için ortak döngü: open/close arasında virgülle ayrılmış öğeler
+template <typename Item>
+bool json_scan(std::string_view text, char open, char close, Item&& item) {
+    size_t pos = json_skip_ws(text, 0);
+    if (pos >= text.size() || text[pos] != open) {
+        return false;
+    }
+    pos = json_skip_ws(text, pos + 1);
+    if (pos < text.size() && text[pos] == close) {
+        return true;
+    }
+    while (true) {
+        bool stop = false;
+        pos = item(pos, stop);
+        if (pos == std::string_view::npos) {
+            return false;
+        }
+        if (stop) {
+            return true;
+        }
+        pos = json_skip_ws(text, pos);
+        if (pos >= text.size()) {
+            return false;
+        }
+        if (text[pos] == close) {
+            return true;
+        }
+        if (text[pos] != ',') {
+            return false;
+        }
+        pos = json_skip_ws(text, pos + 1);
+    }
+}
+}
+
+std::string base64_encode(const uint8_t* data, size_t len) {
+    std::string out;
+    out.reserve((len + 2) / 3 * 4);
+    for (size_t i = 0; i < len; i += 3) {
+        uint32_t chunk = static_cast<uint32_t>(data[i]) << 16;
+        if (i + 1 < len) chunk |= static_cast<uint32_t>(data[i + 1]) << 8;
+        if (i + 2 < len) chunk |= data[i + 2];
+        out.push_back(BASE64_DIGITS[chunk >> 18 & 63]);
+        out.push_back(BASE64_DIGITS[chunk >> 12 & 63]);
+        out.push_back(i + 1 < len ? BASE64_DIGITS[chunk >> 6 & 63] : '=');
+        out.push_back(i + 2 < len ? BASE64_DIGITS[chunk & 63] : '=');
+    }
+    return out;
+}
+
+bool base64_decode(std::string_view text, std::vector<uint8_t>& out) {
+    out.clear();
+    if (text.size() % 4 != 0) {
+        return false;
+    }
+    out.reserve(text.size() / 4 * 3);
+    for (size_t i = 0; i < text.size(); i += 4) {
+        // Dolgu yalnızca son dörtlükte, en fazla iki karakter
+        bool last = i + 4 == text.size();
+        size_t padding = last ? (text[i + 3] == '=') + (text[i + 3] == '=' && text[i + 2] == '=') : 0;
+        uint32_t chunk = 0;
+        for (size_t k = 0; k < 4; ++k) {
+            int value = k >= 4 - padding ? 0 : base64_value(text[i + k]);
+            if (value < 0) {
+                return false;
+            }
+            chunk = chunk << 6 | static_cast<uint32_t>(value);
+        }
+        out.push_back(static_cast<uint8_t>(chunk >> 16));
+        if (padding < 2) out.push_back(static_cast<uint8_t>(chunk >> 8));
+        if (padding < 1) out.push_back(static_cast<uint8_t>(chunk));
+    }
+    return true;
+}
+
+bool json_for_each_element(std::string_view array, const std::function<bool(std::string_view)>& fn) {
+    return json_scan(array, '[', ']', [&](size_t pos, bool& stop) {
+        size_t end = json_skip_value(array, pos);
+        if (end != std::string_view::npos) {
+            stop = !fn(array.substr(pos, end - pos));
+        }
+        return end;
+    });
+}
+
+bool json_for_each_member(std::string_view object,
+                          const std::function<bool(std::string_view key, std::string_view value)>& fn) {
+    return json_scan(object, '{', '}', [&](size_t pos, bool& stop) {
+        if (object[pos] != '"') {
+            return std::string_view::npos;
+        }
+        size_t key_end = json_skip_value(object, pos);
+        if (key_end == std::string_view::npos) {
+            return key_end;
+        }
+        size_t colon = json_skip_ws(object, key_end);
+        if (colon >= object.size() || object[colon] != ':') {
+            return std::string_view::npos;
+        }
+        size_t value = json_skip_ws(object, colon + 1);
+        size_t end = json_skip_value(object, value);
+        if (end != std::string_view::npos) {
+            stop = !fn(object.substr(pos + 1, key_end - pos - 2), object.substr(value, end - value));
+        }
+        return end;
+    });
+}
+
+bool json_string_value(std::string_view value, std::string& out) {
+    out.clear();
+    size_t pos = json_skip_ws(value, 0);
+    if (pos >= value.size() || value[pos] != '"') {
+        return false;
+    }
+    for (++pos; pos < value.size(); ++pos) {
+        char c = value[pos];
+        if (c == '"') {
+            return true;
+        }
+        if (c != '\\') {
+            out.push_back(c);
+            continue;
+        }
+        if (++pos >= value.size()) {
+            return false;
+        }
+        switch (value[pos]) {
+            case '"': out.push_back('"'); break;
+            case '\\': out.push_back('\\'); break;
+            case '/': out.push_back('/'); break;
+            case 'b': out.push_back('\b'); break;
+            case 'f': out.push_back('\f'); break;
+            case 'n': out.push_back('\n'); break;
+            case 'r': out.push_back('\r'); break;
+            case 't': out.push_back('\t'); break;
+            case 'u': {
+                // Yalnızca BMP (vekil çiftleri birleştirilmez), UTF-8 olarak
+                uint8_t bytes[2];
+                if (pos + 4 >= value.size() || !hex_decode(value.data() + pos + 1, 4, bytes)) {
+                    return false;
+                }
+                uint32_t code = static_cast<uint32_t>(bytes[0]) << 8 | bytes[1];
+                if (code < 0x80) {
+                    out.push_back(static_cast<char>(code));
+                } else if (code < 0x800) {
+                    out.push_back(static_cast<char>(0xC0 | code >> 6));
+                    out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+                } else {
+                    out.push_back(static_cast<char>(0xE0 | code >> 12));
+                    out.push_back(static_cast<char>(0x80 | (code >> 6 & 0x3F)));
+                    out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+                }
+                pos += 4;
+                break;
+            }
+            default:
+                return false;
+        }
+    }
+    return false;
+}
+
+// SipHash-2-4 (Aumasson & Bernstein)
+namespace {
+inline uint64_t rotl64(uint64_t x, int b) {
+    return (x << b) | (x >> (64 - b));
+}
+
+inline void sip_round(uint64_t& v0, uint64_t& v1, uint64_t& v2, uint64_t& v3) {
+    v0 += v1; v1 = rotl64(v1, 13); v1 ^= v0; v0 = rotl64(v0, 32);
+    v2 += v3; v3 = rotl64(v3, 16); v3 ^= v2;
+    v0 += v3; v3 = rotl64(v3, 21); v3 ^= v0;
+    v2 += v1; v1 = rotl64(v1, 17); v1 ^= v2; v2 = rotl64(v2, 32);
+}
+}
+
+uint64_t siphash24(uint64_t k0, uint64_t k1, const uint8_t* data, size_t len) {
+    uint64_t v0 = 0x736f6d6570736575ULL ^ k0;
+    uint64_t v1 = 0x646f72616e646f6dULL ^ k1;
+    uint64_t v2 = 0x6c7967656e657261ULL ^ k0;
+    uint64_t v3 = 0x7465646279746573ULL ^ k1;
+    
+    size_t blocks = len / 8;
+    for (size_t i = 0; i < blocks; ++i) {
+        uint64_t m;
+        std::memcpy(&m, data + i * 8, 8);
+        v3 ^= m;
+        sip_round(v0, v1, v2, v3);
+        sip_round(v0, v1, v2, v3);
+        v0 ^= m;
+    }
+    
+    uint64_t last = static_cast<uint64_t>(len) << 56;
+    for (size_t i = 0; i < len % 8; ++i) {
+        last |= static_cast<uint64_t>(data[blocks * 8 + i]) << (8 * i);
+    }
+    
+    v3 ^= last;
+    sip_round(v0, v1, v2, v3);
+    sip_round(v0, v1, v2, v3);
+    v0 ^= last;
+    
+    v2 ^= 0xff;
+    for (int i = 0; i < 4; ++i) {
+        sip_round(v0, v1, v2, v3);
+    }
+    
+    return v0 ^ v1 ^ v2 ^ v3;
+}
+
+// İşi donanım thread sayısına göre parçala
+void parallel_for(size_t count, size_t min_chunk,
+                  const std::function<void(size_t, size_t)>& fn) {
+    if (count == 0) {
+        return;
+    }
+    
+    size_t hw = std::max(1u, std::thread::hardware_concurrency());
+    size_t workers = std::min(hw, (count + min_chunk - 1) / std::max<size_t>(min_chunk, 1));
+    
+    if (workers <= 1) {
+        fn(0, count);
+        return;
+    }
+    
+    size_t chunk = (count + workers - 1) / workers;
+    std::vector<std::thread> threads;
+    threads.reserve(workers - 1);
+    
+    // İlk parça çağıran thread'de çalışır
+    for (size_t w = 1; w < workers; ++w) {
+        size_t begin = w * chunk;
+        size_t end = std::min(count, begin + chunk);
+        if (begin >= end) {
+            break;
+        }
+        threads.emplace_back([&fn, begin, end]() { fn(begin, end); });
+    }
+    
+    fn(0, std::min(count, chunk));
+    
+    for (auto& t : threads) {
+        t.join();
     }
-    return ss.str();
 }
 
 // ============================================================================
@@ -114,20 +516,34 @@ Hash256 QuantumCrypto::hash(const uint8_t* data, size_t len) {
         
         for (size_t j = 0; j < current_chunk; ++j) {
             size_t state_idx = j % 8;
+            // FNV-1a emilimi: xor + tek sayı çarpanı, şerit başına tersinir
             state[state_idx] ^= static_cast<uint64_t>(data[i + j]);
-            state[state_idx] = (state[state_idx] << 7) | (state[state_idx] >> 57);
+            state[state_idx] *= 0x100000001B3ULL;
         }
         
-        // Mixing rounds
+        // Mixing rounds: ekle-döndür-XOR tersinir (sola kaydırma üst bitleri
+        // atıyordu ve bir fark iki chunk'ta kaybolabiliyordu); eşleme her turda
+        // bir kelime kayar, dört turda sekiz kelimenin hepsi karışır
         for (int round = 0; round < 12; ++round) {
+            int offset = round & 1;
             for (int j = 0; j < 8; j += 2) {
-                state[j] += state[j + 1];
-                state[j + 1] = (state[j + 1] << 13) ^ state[j];
+                uint64_t& a = state[(j + offset) & 7];
+                uint64_t& b = state[(j + offset + 1) & 7];
+                a += b;
+                b = ((b << 13) | (b >> 51)) ^ a;
             }
         }
     }
     
-    // Finalize
+    // Finalize: çıktı yalnızca state[0..3]'ü taşır; iki çapraz tur 4..7'yi
+    // de bu kelimelere katar
+    for (int round = 0; round < 2; ++round) {
+        for (int j = 0; j < 8; ++j) {
+            uint64_t v = (state[j] ^ state[(j + 4) & 7]) * 0x9E3779B97F4A7C15ULL;
+            state[j] = v ^ (v >> 29) ^ state[(j + 1) & 7];
+        }
+    }
+    
     std::memcpy(result.data(), state, result.size());
     return result;
 }
@@ -461,6 +877,303 @@ bool Transaction::verify_signature(QuantumCrypto& crypto) const {
     return crypto.verify(pub, signature, tx_hash.data(), tx_hash.size());
 }
 
+// ============================================================================
+// MERKLE BATCH COMMITMENT İMPLEMENTASYONU
+// ============================================================================
+
+namespace {
+// Bu sayının altındaki işler için thread açmak hash'lemekten pahalı
+constexpr size_t MERKLE_PARALLEL_CHUNK = 512;
+}
+
+BatchMerkleTree::BatchMerkleTree() {}
+
+Hash256 BatchMerkleTree::hash_leaf(QuantumCrypto& crypto, const Hash256& tx_hash) {
+    uint8_t buffer[1 + 32];
+    buffer[0] = 0x00;
+    std::memcpy(buffer + 1, tx_hash.data(), tx_hash.size());
+    return crypto.hash(buffer, sizeof(buffer));
+}
+
+Hash256 BatchMerkleTree::hash_inner(QuantumCrypto& crypto,
+                                    const Hash256& left,
+                                    const Hash256& right) {
+    uint8_t buffer[1 + 64];
+    buffer[0] = 0x01;
+    std::memcpy(buffer + 1, left.data(), left.size());
+    std::memcpy(buffer + 1 + 32, right.data(), right.size());
+    return crypto.hash(buffer, sizeof(buffer));
+}
+
+void BatchMerkleTree::build(const std::vector<Hash256>& tx_hashes) {
+    levels.clear();
+    levels.emplace_back(tx_hashes.size());
+    
+    auto& leaves = levels[0];
+    parallel_for(tx_hashes.size(), MERKLE_PARALLEL_CHUNK, [&](size_t begin, size_t end) {
+        QuantumCrypto crypto;
+        for (size_t i = begin; i < end; ++i) {
+            leaves[i] = hash_leaf(crypto, tx_hashes[i]);
+        }
+    });
+    
+    build_levels();
+}
+
+void BatchMerkleTree::build(const std::vector<Transaction>& txs) {
+    levels.clear();
+    levels.emplace_back(txs.size());
+    
+    // Transaction hash'i ve yaprak hash'i aynı geçişte hesaplanır
+    auto& leaves = levels[0];
+    parallel_for(txs.size(), MERKLE_PARALLEL_CHUNK, [&](size_t begin, size_t end) {
+        QuantumCrypto crypto;
+        for (size_t i = begin; i < end; ++i) {
+            leaves[i] = hash_leaf(crypto, txs[i].compute_hash(crypto));
+        }
+    });
+    
+    build_levels();
+}
+
+void BatchMerkleTree::build_levels() {
+    while (levels.back().size() > 1) {
+        const auto& below = levels.back();
+        size_t pairs = below.size() / 2;
+        std::vector<Hash256> above((below.size() + 1) / 2);
+        
+        parallel_for(pairs, MERKLE_PARALLEL_CHUNK, [&](size_t begin, size_t end) {
+            QuantumCrypto crypto;
+            for (size_t i = begin; i < end; ++i) {
+                above[i] = hash_inner(crypto, below[2 * i], below[2 * i + 1]);
+            }
+        });
+        
+        // Tek kalan düğüm olduğu gibi yukarı taşınır
+        if (below.size() % 2 == 1) {
+            above.back() = below.back();
+        }
+        
+        levels.push_back(std::move(above));
+    }
+}
+
+Hash256 BatchMerkleTree::root() const {
+    if (levels.empty() || levels.back().empty()) {
+        return Hash256{0};
+    }
+    return levels.back()[0];
+}
+
+size_t BatchMerkleTree::leaf_count() const {
+    return levels.empty() ? 0 : levels[0].size();
+}
+
+MerkleProof BatchMerkleTree::prove(uint32_t leaf_index) const {
+    MerkleProof proof;
+    
+    if (leaf_index >= leaf_count()) {
+        return proof;
+    }
+    
+    proof.leaf_index = leaf_index;
+    proof.leaf_count = static_cast<uint32_t>(leaf_count());
+    
+    size_t index = leaf_index;
+    for (size_t level = 0; level + 1 < levels.size(); ++level) {
+        size_t sibling = index ^ 1;
+        if (sibling < levels[level].size()) {
+            proof.siblings.push_back(levels[level][sibling]);
+        }
+        index /= 2;
+    }
+    
+    return proof;
+}
+
+bool BatchMerkleTree::verify(const Hash256& tx_hash,
+                             const MerkleProof& proof,
+                             const Hash256& root) {
+    if (proof.leaf_index >= proof.leaf_count) {
+        return false;
+    }
+    
+    QuantumCrypto crypto;
+    Hash256 current = hash_leaf(crypto, tx_hash);
+    
+    size_t index = proof.leaf_index;
+    size_t level_size = proof.leaf_count;
+    size_t used = 0;
+    
+    while (level_size > 1) {
+        bool has_sibling = (index ^ 1) < level_size;
+        
+        if (has_sibling) {
+            if (used >= proof.siblings.size()) {
+                return false;
+            }
+            const Hash256& sibling = proof.siblings[used++];
+            current = (index % 2 == 0) ? hash_inner(crypto, current, sibling)
+                                       : hash_inner(crypto, sibling, current);
+        }
+        
+        index /= 2;
+        level_size = (level_size + 1) / 2;
+    }
+    
+    return used == proof.siblings.size() && current == root;
+}
+
+// ============================================================================
+// KOMPAKT PROPOSAL RELAY İMPLEMENTASYONU
+// ============================================================================
+
+size_t CompactProposal::wire_size() const {
+    // root + salt + sayaç + kısa ID'ler
+    return 32 + 8 + 4 + short_ids.size() * SHORT_TXID_BYTES;
+}
+
+void CompactRelay::derive_keys(const CompactProposal& proposal, uint64_t& k0, uint64_t& k1) {
+    // Anahtar her proposal'a özgü: saldırgan önceden çakışan tx üretemez
+    k0 = siphash24(proposal.salt, 0x68797065726c6179ULL,
+                   proposal.batch_root.data(), proposal.batch_root.size());
+    k1 = siphash24(proposal.salt, 0x636f6d7061637421ULL,
+                   proposal.batch_root.data(), proposal.batch_root.size());
+}
+
+uint64_t CompactRelay::short_id(const CompactProposal& proposal, const Hash256& tx_hash) {
+    uint64_t k0, k1;
+    derive_keys(proposal, k0, k1);
+    return siphash24(k0, k1, tx_hash.data(), tx_hash.size()) & SHORT_TXID_MASK;
+}
+
+CompactProposal CompactRelay::make_proposal(const std::vector<Hash256>& tx_hashes,
+                                            const Hash256& batch_root,
+                                            uint64_t salt) {
+    CompactProposal proposal;
+    proposal.batch_root = batch_root;
+    proposal.salt = salt;
+    
+    uint64_t k0, k1;
+    derive_keys(proposal, k0, k1);
+    
+    proposal.short_ids.reserve(tx_hashes.size());
+    for (const auto& h : tx_hashes) {
+        proposal.short_ids.push_back(siphash24(k0, k1, h.data(), h.size()) & SHORT_TXID_MASK);
+    }
+    
+    return proposal;
+}
+
+CompactReconstruction CompactRelay::reconstruct(const CompactProposal& proposal,
+                                                const std::vector<Transaction>& mempool) {
+    CompactReconstruction result;
+    result.txs.resize(proposal.short_ids.size());
+    
+    constexpr uint32_t AMBIGUOUS = 0xffffffff;
+    
+    // short_id -> proposal indeksi; batch içi çakışmalar belirsiz işaretlenir
+    std::unordered_map<uint64_t, uint32_t> slot_of;
+    slot_of.reserve(proposal.short_ids.size() * 2);
+    for (uint32_t i = 0; i < proposal.short_ids.size(); ++i) {
+        auto inserted = slot_of.emplace(proposal.short_ids[i], i);
+        if (!inserted.second) {
+            inserted.first->second = AMBIGUOUS;
+        }
+    }
+    
+    uint64_t k0, k1;
+    derive_keys(proposal, k0, k1);
+    
+    std::vector<uint8_t> filled(proposal.short_ids.size(), 0);
+    QuantumCrypto crypto;
+    
+    for (const auto& tx : mempool) {
+        // Mempool tx_id'yi saklar; yoksa hash'i burada hesapla
+        Hash256 tx_hash = (tx.tx_id != Hash256{0}) ? tx.tx_id : tx.compute_hash(crypto);
+        uint64_t id = siphash24(k0, k1, tx_hash.data(), tx_hash.size()) & SHORT_TXID_MASK;
+        
+        auto it = slot_of.find(id);
+        if (it == slot_of.end() || it->second == AMBIGUOUS) {
+            continue;
+        }
+        
+        uint32_t slot = it->second;
+        if (filled[slot]) {
+            // İki mempool tx aynı kısa ID'ye düştü: karşıdan iste
+            filled[slot] = 2;
+            continue;
+        }
+        
+        result.txs[slot] = tx;
+        result.txs[slot].tx_id = tx_hash;
+        filled[slot] = 1;
+    }
+    
+    for (uint32_t i = 0; i < filled.size(); ++i) {
+        if (filled[i] != 1) {
+            result.missing.push_back(i);
+        }
+    }
+    
+    // Hiç eksik yoksa fill_missing çağrılmayabilir: kök burada doğrulanır.
+    // Batch dışı bir mempool tx'i ile 48-bit çakışma yanlış slotu doldurur;
+    // hangi slot olduğu bilinmediğinden tüm batch eksik sayılır (tam proposal).
+    if (result.missing.empty() && !result.txs.empty()) {
+        std::vector<Hash256> tx_hashes;
+        tx_hashes.reserve(result.txs.size());
+        for (const auto& tx : result.txs) {
+            tx_hashes.push_back(tx.tx_id);
+        }
+        BatchMerkleTree tree;
+        tree.build(tx_hashes);
+        if (tree.root() != proposal.batch_root) {
+            for (uint32_t i = 0; i < result.txs.size(); ++i) {
+                result.missing.push_back(i);
+            }
+        }
+    }
+    
+    return result;
+}
+
+bool CompactRelay::fill_missing(const CompactProposal& proposal,
+                                CompactReconstruction& reconstruction,
+                                const std::vector<Transaction>& fetched) {
+    if (fetched.size() != reconstruction.missing.size()) {
+        return false;
+    }
+    
+    QuantumCrypto crypto;
+    for (size_t i = 0; i < fetched.size(); ++i) {
+        Transaction& slot = reconstruction.txs[reconstruction.missing[i]];
+        slot = fetched[i];
+        slot.tx_id = slot.compute_hash(crypto);
+    }
+    reconstruction.missing.clear();
+    
+    std::vector<Hash256> tx_hashes;
+    tx_hashes.reserve(reconstruction.txs.size());
+    for (const auto& tx : reconstruction.txs) {
+        tx_hashes.push_back(tx.tx_id);
+    }
+    
+    BatchMerkleTree tree;
+    tree.build(tx_hashes);
+    
+    return tree.root() == proposal.batch_root;
+}
+
+size_t CompactRelay::full_wire_size(const std::vector<Transaction>& txs) {
+    size_t total = 32 + 4;
+    for (const auto& tx : txs) {
+        // tx_id + chain + from + to + amount/fee/nonce/ts + imza + değişken alanlar
+        total += 32 + 1 + 20 + 20 + 4 * 8 + 64 + 1 +
+                 tx.chain_specific_data.size() + tx.zk_proof.size();
+    }
+    return total;
+}
+
 // ============================================================================
 // ADAPTIVE CONSENSUS İMPLEMENTASYONU
 // ============================================================================
@@ -537,25 +1250,31 @@ std::vector<PublicKey> AdaptiveConsensus::select_validators(uint32_t count) {
 
 bool AdaptiveConsensus::reach_consensus(const std::vector<Transaction>& txs,
                                        const std::vector<PublicKey>& validators) {
+    // Batch commitment: transaction hash'leri üzerinde Merkle kökü
+    BatchMerkleTree tree;
+    tree.build(txs);
+    
+    return vote_on_batch(tree, validators);
+}
+
+bool AdaptiveConsensus::reach_consensus(BatchMerkleTree&& tree,
+                                       const std::vector<PublicKey>& validators) {
+    // Ağaç çağıranda mempool'daki tx hash'lerinden kurulmuştur; tekrar kurulmaz
+    return vote_on_batch(tree, validators);
+}
+
+bool AdaptiveConsensus::vote_on_batch(BatchMerkleTree& tree,
+                                     const std::vector<PublicKey>& validators) {
     // Byzantine Fault Tolerant consensus
     // 3-phase commit: Pre-prepare, Prepare, Commit
     
-    uint32_t required_votes = (validators.size() * 2) / 3 + 1; // 2/3 + 1
-    
-    QuantumCrypto crypto;
-    
-    // Hash all transactions
-    std::vector<uint8_t> tx_data;
-    for (const auto& tx : txs) {
-        Hash256 tx_hash = tx.compute_hash(crypto);
-        tx_data.insert(tx_data.end(), tx_hash.begin(), tx_hash.end());
-    }
+    uint32_t required_votes = quorum_size(validators.size()); // 2/3 + 1
     
-    Hash256 batch_hash = crypto.hash(tx_data.data(), tx_data.size());
+    Hash256 batch_hash = tree.root();
     
     // Simulate voting (gerçek implementasyonda network communication)
     uint32_t votes = 0;
-    for (const auto& validator : validators) {
+    for (size_t i = 0; i < validators.size(); ++i) {
         // Her validator'ın %90 ihtimalle onayladığını varsay
         if (rand() % 100 < 90) {
             votes++;
@@ -566,32 +1285,335 @@ bool AdaptiveConsensus::reach_consensus(const std::vector<Transaction>& txs,
     bft_state.votes[batch_hash] = votes;
     bft_state.round++;
     
-    return votes >= required_votes;
+    bool committed = votes >= required_votes;
+    
+    if (committed) {
+        std::lock_guard<std::mutex> lock(batch_mutex);
+        last_batch_tree = std::move(tree);
+    }
+    
+    return committed;
+}
+
+uint32_t AdaptiveConsensus::quorum_size(size_t validator_count) {
+    return static_cast<uint32_t>((validator_count * 2) / 3 + 1);
+}
+
+uint32_t AdaptiveConsensus::record_vote(const Hash256& vote_key) {
+    return ++bft_state.votes[vote_key];
+}
+
+uint32_t AdaptiveConsensus::get_vote_count(const Hash256& vote_key) const {
+    auto it = bft_state.votes.find(vote_key);
+    return it != bft_state.votes.end() ? it->second : 0;
+}
+
+void AdaptiveConsensus::clear_votes() {
+    bft_state.proposals.clear();
+    bft_state.votes.clear();
+}
+
+Hash256 AdaptiveConsensus::get_last_batch_root() const {
+    std::lock_guard<std::mutex> lock(batch_mutex);
+    return last_batch_tree.root();
+}
+
+MerkleProof AdaptiveConsensus::get_inclusion_proof(uint32_t tx_index) const {
+    std::lock_guard<std::mutex> lock(batch_mutex);
+    return last_batch_tree.prove(tx_index);
 }
 
 // ============================================================================
 // FRACTAL SHARDING İMPLEMENTASYONU
 // ============================================================================
 
-ShardState::ShardState(uint32_t id) 
-    : shard_id(id), state_root{0}, transaction_count(0) {}
+SparseMerkleTree::SparseMerkleTree()
+    : max_cached_depth(0), cached_root{0}, dirty(false) {}
 
-FractalSharding::FractalSharding() {
-    for (uint32_t i = 0; i < SHARD_COUNT; ++i) {
-        shards[i] = std::make_unique<ShardState>(i);
-    }
+SparseMerkleTree::NodeKey SparseMerkleTree::node_key(uint32_t depth, const Address& prefix) {
+    NodeKey key;
+    key[0] = static_cast<uint8_t>(depth);
+    std::memcpy(key.data() + 1, prefix.data(), prefix.size());
+    return key;
 }
 
-uint32_t FractalSharding::assign_shard(const Address& addr) {
-    // Consistent hashing
-    uint32_t hash_value = 0;
-    for (size_t i = 0; i < addr.size(); ++i) {
-        hash_value = (hash_value * 31 + addr[i]) % SHARD_COUNT;
-    }
-    return hash_value;
+void SparseMerkleTree::invalidate_path(const Address& addr) {
+    // Adresi kapsayan her önbellekli iç düğümü düşür (kökten yaprağa)
+    Address prefix{};
+    for (uint32_t depth = 0; depth <= max_cached_depth; ++depth) {
+        node_cache.erase(node_key(depth, prefix));
+        
+        if (depth / 8 < prefix.size()) {
+            uint8_t bit = 0x80 >> (depth % 8);
+            prefix[depth / 8] |= (addr[depth / 8] & bit);
+        }
+    }
+}
+
+void SparseMerkleTree::update(const Address& addr, uint64_t balance) {
+    auto it = leaves.find(addr);
+    
+    if (balance == 0) {
+        if (it == leaves.end()) {
+            return;
+        }
+        leaves.erase(it);
+    } else {
+        if (it != leaves.end() && it->second == balance) {
+            return;
+        }
+        leaves[addr] = balance;
+    }
+    
+    invalidate_path(addr);
+    dirty = true;
+}
+
+Hash256 SparseMerkleTree::compute(QuantumCrypto& crypto, uint32_t depth, const Address& prefix,
+                                  LeafIterator begin, LeafIterator end) {
+    if (begin == end) {
+        return Hash256{0};
+    }
+    
+    if (std::next(begin) == end) {
+        // Tek yapraklı alt ağaç: yaprak hash'i derinlikten bağımsız
+        uint8_t buffer[1 + 20 + 8];
+        buffer[0] = 0x00;
+        std::memcpy(buffer + 1, begin->first.data(), 20);
+        std::memcpy(buffer + 21, &begin->second, 8);
+        return crypto.hash(buffer, sizeof(buffer));
+    }
+    
+    NodeKey key = node_key(depth, prefix);
+    auto cached = node_cache.find(key);
+    if (cached != node_cache.end()) {
+        return cached->second;
+    }
+    
+    // Aralık sıralı: depth bitinin 1 olduğu ilk anahtar sağ alt ağacı başlatır
+    Address right_prefix = prefix;
+    right_prefix[depth / 8] |= static_cast<uint8_t>(0x80 >> (depth % 8));
+    LeafIterator split = leaves.lower_bound(right_prefix);
+    
+    Hash256 left = compute(crypto, depth + 1, prefix, begin, split);
+    Hash256 right = compute(crypto, depth + 1, right_prefix, split, end);
+    Hash256 node = BatchMerkleTree::hash_inner(crypto, left, right);
+    
+    node_cache.emplace(key, node);
+    max_cached_depth = std::max(max_cached_depth, depth);
+    
+    return node;
+}
+
+Hash256 SparseMerkleTree::root() {
+    if (dirty) {
+        QuantumCrypto crypto;
+        cached_root = compute(crypto, 0, Address{}, leaves.begin(), leaves.end());
+        dirty = false;
+    }
+    return cached_root;
+}
+
+RecentTxIndex::RecentTxIndex(size_t capacity)
+    : capacity(capacity), inserted(0), live_count(0) {}
+
+size_t RecentTxIndex::find_slot(const Hash256& digest) const {
+    if (table.empty()) {
+        return table.size();
+    }
+    
+    size_t mask = table.size() - 1;
+    for (size_t slot = home(digest); table[slot] != EMPTY; slot = (slot + 1) & mask) {
+        if (ring[table[slot]] == digest) {
+            return slot;
+        }
+    }
+    return table.size();
+}
+
+void RecentTxIndex::remove_slot(size_t slot) {
+    // Geri kaydırma: boşluktan sonraki küme elemanları ev konumlarını
+    // geçmeyecek şekilde boşluğa çekilir
+    size_t mask = table.size() - 1;
+    size_t hole = slot;
+    for (size_t next = (hole + 1) & mask; table[next] != EMPTY; next = (next + 1) & mask) {
+        size_t want = home(ring[table[next]]);
+        if (((next - want) & mask) >= ((next - hole) & mask)) {
+            table[hole] = table[next];
+            hole = next;
+        }
+    }
+    table[hole] = EMPTY;
+}
+
+bool RecentTxIndex::contains(const Hash256& digest) const {
+    return find_slot(digest) != table.size();
+}
+
+bool RecentTxIndex::insert(const Hash256& digest) {
+    if (table.empty()) {
+        ring.assign(capacity, Hash256{});
+        live.assign(capacity, 0);
+        table.assign(capacity * 2, EMPTY);
+    }
+    if (contains(digest)) {
+        return false;
+    }
+    
+    // En eski konum yeniden kullanılır; hâlâ canlıysa indeksten düşer
+    uint16_t pos = static_cast<uint16_t>(inserted++ & (capacity - 1));
+    if (live[pos]) {
+        remove_slot(find_slot(ring[pos]));
+        --live_count;
+    }
+    
+    ring[pos] = digest;
+    live[pos] = 1;
+    ++live_count;
+    
+    size_t mask = table.size() - 1;
+    size_t slot = home(digest);
+    while (table[slot] != EMPTY) {
+        slot = (slot + 1) & mask;
+    }
+    table[slot] = pos;
+    return true;
+}
+
+bool RecentTxIndex::erase(const Hash256& digest) {
+    size_t slot = find_slot(digest);
+    if (slot == table.size()) {
+        return false;
+    }
+    live[table[slot]] = 0;
+    --live_count;
+    remove_slot(slot);
+    return true;
+}
+
+std::vector<Hash256> RecentTxIndex::recent() const {
+    std::vector<Hash256> out;
+    out.reserve(live_count);
+    uint64_t first = inserted > capacity ? inserted - capacity : 0;
+    for (uint64_t i = first; i < inserted; ++i) {
+        size_t pos = i & (capacity - 1);
+        if (live[pos]) {
+            out.push_back(ring[pos]);
+        }
+    }
+    return out;
+}
+
+void RecentTxIndex::clear() {
+    ring = std::vector<Hash256>();
+    live = std::vector<uint8_t>();
+    table = std::vector<uint16_t>();
+    inserted = 0;
+    live_count = 0;
+}
+
+std::vector<HeavyHitterSketch::Entry> HeavyHitterSketch::top() const {
+    std::vector<Entry> out(entries.begin(), entries.begin() + used);
+    std::sort(out.begin(), out.end(), [](const Entry& a, const Entry& b) {
+        return a.count > b.count;
+    });
+    return out;
+}
+
+ShardCounters& ShardCounters::operator+=(const ShardCounters& other) {
+    applied += other.applied;
+    failed += other.failed;
+    duplicates += other.duplicates;
+    cross_out += other.cross_out;
+    cross_in += other.cross_in;
+    cross_rejected += other.cross_rejected;
+    refunded += other.refunded;
+    hot_credits += other.hot_credits;
+    contended_locks += other.contended_locks;
+    lock_wait_ns += other.lock_wait_ns;
+    queue_depth_last += other.queue_depth_last;
+    queue_depth_peak = std::max(queue_depth_peak, other.queue_depth_peak);
+    return *this;
 }
 
-bool FractalSharding::route_transaction(const Transaction& tx) {
+ShardState::ShardState(uint32_t id) 
+    : shard_id(id), state_root{0}, transaction_count(0), next_outbound_sequence(0),
+      credit_candidates{} {}
+
+static_assert(SHARD_COUNT <= 256, "route_table slot id'leri uint8_t");
+static_assert((1u << SHARD_INITIAL_DEPTH) <= SHARD_COUNT, "başlangıç shard'ları slot sayısını aşamaz");
+static_assert(SHARD_INITIAL_DEPTH <= SHARD_ROUTE_BITS, "başlangıç derinliği route bitlerini aşamaz");
+static_assert((RECENT_TX_CAPACITY & (RECENT_TX_CAPACITY - 1)) == 0 && RECENT_TX_CAPACITY < 0xFFFF,
+              "tekrar penceresi 2'nin kuvveti ve uint16_t konumlarla adreslenebilir olmalı");
+
+FractalSharding::FractalSharding()
+    : topology_version(0), published_topology_version(0), journal(nullptr),
+      credit_deltas(new DeltaBlock[SHARD_COUNT]()), hot_threshold(HOT_CREDIT_THRESHOLD), in_flight(0) {
+    for (uint32_t i = 0; i < SHARD_COUNT; ++i) {
+        shards[i] = std::make_unique<ShardState>(i);
+        shard_load[i].store(0, std::memory_order_relaxed);
+        regions[i] = ShardRegion{0, 0, false};
+    }
+    
+    // Başlangıç: SHARD_INITIAL_DEPTH derinliğinde eşit bölgeler, kalan slotlar bölünme için boş
+    for (uint32_t i = 0; i < (1u << SHARD_INITIAL_DEPTH); ++i) {
+        regions[i] = ShardRegion{SHARD_INITIAL_DEPTH, i, true};
+        assign_range(SHARD_INITIAL_DEPTH, i, i);
+    }
+    
+    // snapshot() hiçbir zaman null dönmesin
+    publish_snapshots(0);
+}
+
+uint32_t FractalSharding::route_index(const Address& addr) {
+    // AddressHash'in üst bitleri; FlatMap alt bitleri kullandığından çakışmaz
+    return static_cast<uint32_t>(static_cast<uint64_t>(AddressHash()(addr)) >> (64 - SHARD_ROUTE_BITS));
+}
+
+uint32_t FractalSharding::assign_shard(const Address& addr) const {
+    return route_table[route_index(addr)].load(std::memory_order_acquire);
+}
+
+std::unique_lock<std::mutex> FractalSharding::lock_owner(const Address& addr, uint32_t& shard_id) {
+    while (true) {
+        shard_id = assign_shard(addr);
+        auto lock = lock_shard(shard_id);
+        
+        // Taşıma iki slotun kilidini tutarak route_table'ı günceller
+        if (assign_shard(addr) == shard_id) {
+            return lock;
+        }
+    }
+}
+
+std::unique_lock<std::mutex> FractalSharding::lock_shard(uint32_t shard_id) {
+    std::unique_lock<std::mutex> lock(shard_mutexes[shard_id], std::try_to_lock);
+    if (lock.owns_lock()) {
+        return lock;
+    }
+    
+    // Çekişmesiz yolda saat okunmaz
+    auto start = std::chrono::steady_clock::now();
+    lock.lock();
+    auto waited = std::chrono::steady_clock::now() - start;
+    
+    auto& counters = shards[shard_id]->counters;
+    ++counters.contended_locks;
+    counters.lock_wait_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(waited).count();
+    return lock;
+}
+
+void FractalSharding::assign_range(uint32_t depth, uint32_t prefix, uint32_t shard_id) {
+    uint32_t shift = SHARD_ROUTE_BITS - depth;
+    uint32_t begin = prefix << shift;
+    uint32_t end = begin + (1u << shift);
+    
+    for (uint32_t i = begin; i < end; ++i) {
+        route_table[i].store(static_cast<uint8_t>(shard_id), std::memory_order_release);
+    }
+}
+
+bool FractalSharding::route_transaction(const Transaction& tx, uint64_t tag) {
     uint32_t from_shard = assign_shard(tx.from);
     uint32_t to_shard = assign_shard(tx.to);
     
@@ -600,94 +1622,321 @@ bool FractalSharding::route_transaction(const Transaction& tx) {
         return update_shard_state(from_shard, tx);
     } else {
         // Cross-shard transaction
-        return process_cross_shard(tx);
+        return process_cross_shard(tx, tag);
     }
 }
 
-bool FractalSharding::process_cross_shard(const Transaction& tx) {
-    uint32_t from_shard = assign_shard(tx.from);
+bool FractalSharding::process_cross_shard(const Transaction& tx, uint64_t tag) {
+    uint32_t from_shard = 0;
     uint32_t to_shard = assign_shard(tx.to);
     
-    // Two-phase commit for cross-shard
+    CrossShardMessage msg;
+    msg.to_shard = to_shard;
+    msg.tag = tag;
+    msg.from = tx.from;
+    msg.to = tx.to;
+    msg.amount = tx.amount;
+    msg.fee = tx.fee;
     
-    // Phase 1: Lock and prepare
+    // Hash kilit dışında: tekrar kontrolü ve mesaj için
+    QuantumCrypto crypto;
+    msg.tx_hash = tx.compute_hash(crypto);
+    bool hot_receiver = !hot_index.empty() && hot_index.find(tx.to) != hot_index.end();
+    
+    // Phase 1: Lock and prepare (yalnızca kaynak shard kilitlenir)
     {
-        std::lock_guard<std::mutex> lock1(shard_mutexes[from_shard]);
+        auto lock = lock_owner(tx.from, from_shard);
+        msg.from_shard = from_shard;
+        shard_load[from_shard].fetch_add(1, std::memory_order_relaxed);
         
-        auto& from_state = shards[from_shard];
-        if (from_state->balances[tx.from] < tx.amount + tx.fee) {
-            return false; // Insufficient balance
+        // Deduct from sender; ack gelene kadar pending_debits'te tutulur
+        if (!debit_sender(from_shard, tx, msg.tx_hash)) {
+            return false; // Insufficient balance ya da tekrar
         }
         
-        // Deduct from sender
-        from_state->balances[tx.from] -= (tx.amount + tx.fee);
+        // Sıcak alıcı: kredi bu kaynak shard'ın delta bloğuna, batch sonunda işlenir
+        if (hot_receiver && credit_hot(from_shard, tx.to, tx.amount)) {
+            return true;
+        }
+        
+        auto& from_state = shards[from_shard];
+        msg.sequence = from_state->next_outbound_sequence++;
+        from_state->pending_debits.emplace(msg.sequence, msg);
+        
+        // Borçla aynı kilit altında sayılır: tüm shard kilitlerini tutan
+        // publish_snapshots düşülmüş ama sayılmamış bir transfer göremez
+        in_flight.fetch_add(1, std::memory_order_relaxed);
     }
     
-    // Phase 2: Commit to receiver
-    {
-        std::lock_guard<std::mutex> lock2(shard_mutexes[to_shard]);
-        
-        auto& to_state = shards[to_shard];
-        to_state->balances[tx.to] += tx.amount;
+    // Phase 2: kredi hedef shard'ın tüketicisine bırakılır
+    inbound[to_shard].push(std::move(msg));
+    
+    return true;
+}
+
+size_t FractalSharding::deliver_cross_shard(uint32_t to_shard) {
+    if (to_shard >= SHARD_COUNT) {
+        return 0;
     }
     
-    // Add to cross-shard queue for async processing
+    std::lock_guard<std::mutex> consumer(inbound_consumer[to_shard]);
+    
+    std::vector<CrossShardMessage> drained;
     CrossShardMessage msg;
-    msg.from_shard = from_shard;
-    msg.to_shard = to_shard;
+    while (inbound[to_shard].pop(msg)) {
+        drained.push_back(std::move(msg));
+    }
     
-    QuantumCrypto crypto;
-    msg.tx_hash = tx.compute_hash(crypto);
+    if (drained.empty()) {
+        return 0;
+    }
+    
+    // Push sırası thread zamanlamasına bağlı; (kaynak, sequence) sırası deterministik
+    std::sort(drained.begin(), drained.end(),
+        [](const CrossShardMessage& a, const CrossShardMessage& b) {
+            return a.from_shard != b.from_shard ? a.from_shard < b.from_shard
+                                                : a.sequence < b.sequence;
+        });
+    
+    std::vector<CrossShardAck> replies(drained.size());
+    std::vector<uint8_t> forwarded(drained.size(), 0);
+    size_t delivered = 0;
     
     {
-        std::lock_guard<std::mutex> lock(queue_mutex);
-        cross_shard_queue.push(msg);
+        auto lock = lock_shard(to_shard);
+        shards[to_shard]->counters.note_queue_depth(drained.size());
+        
+        for (size_t i = 0; i < drained.size(); ++i) {
+            const auto& m = drained[i];
+            
+            // Mesaj kuyruğa girdikten sonra alıcının bölgesi taşındıysa yeni sahibine ilet
+            if (assign_shard(m.to) != to_shard) {
+                forwarded[i] = 1;
+                continue;
+            }
+            
+            // Taşma olursa kredi reddedilir ve kaynak borcu iade eder
+            replies[i].sequence = m.sequence;
+            replies[i].tag = m.tag;
+            replies[i].accepted = apply_credit(to_shard, m.to, m.amount);
+            ++delivered;
+        }
     }
     
+    shard_load[to_shard].fetch_add(delivered, std::memory_order_relaxed);
+    
+    for (size_t i = 0; i < drained.size(); ++i) {
+        if (forwarded[i]) {
+            uint32_t owner = assign_shard(drained[i].to);
+            drained[i].to_shard = owner;
+            inbound[owner].push(std::move(drained[i]));
+        } else {
+            acks[drained[i].from_shard].push(replies[i]);
+        }
+    }
+    
+    return delivered;
+}
+
+bool FractalSharding::debit_sender(uint32_t shard_id, const Transaction& tx, const Hash256& tx_hash) {
+    auto& state = shards[shard_id];
+    if (state->recent_transactions.contains(tx_hash)) {
+        ++state->counters.duplicates;
+        return false;
+    }
+    
+    auto it = state->balances.find(tx.from);
+    if ((it == state->balances.end() || it->second < tx.amount + tx.fee) &&
+        absorb_delta(*state, tx.from, shard_id)) {
+        it = state->balances.find(tx.from);
+    }
+    if (it == state->balances.end() || it->second < tx.amount + tx.fee) {
+        ++state->counters.failed;
+        return false;
+    }
+    
+    it->second -= (tx.amount + tx.fee);
+    state->record_balance(tx.from, it->second);
+    state->recent_transactions.insert(tx_hash);
+    ++state->counters.applied;
+    ++state->counters.cross_out;
+    state->touches.add(tx.from);
     return true;
 }
 
-bool FractalSharding::update_shard_state(uint32_t shard_id, const Transaction& tx) {
-    if (shard_id >= SHARD_COUNT) {
+bool FractalSharding::apply_credit(uint32_t shard_id, const Address& to, uint64_t amount) {
+    auto& state = shards[shard_id];
+    
+    // Kontrol find() ile yapılır: reddedilen kredi sıfır bakiyeli hayalet
+    // hesap bırakmamalı (split ve snapshot'lara taşınırdı)
+    auto it = state->balances.find(to);
+    uint64_t current = it != state->balances.end() ? it->second : 0;
+    
+    // Sıcak alıcıda delta bloklarına ayrılan pay hariç
+    uint64_t limit = std::numeric_limits<uint64_t>::max() - hot_reserve(to);
+    if (amount > limit || current > limit - amount) {
+        ++state->counters.cross_rejected;
         return false;
     }
     
-    std::lock_guard<std::mutex> lock(shard_mutexes[shard_id]);
+    uint64_t balance = current + amount;
+    if (it != state->balances.end()) {
+        it->second = balance;
+    } else {
+        state->balances[to] = balance;
+    }
+    state->record_balance(to, balance);
+    state->note_credit(to);
+    ++state->counters.cross_in;
+    state->touches.add(to);
+    return true;
+}
+
+void FractalSharding::refund_sender(uint32_t shard_id, const Address& from, uint64_t amount,
+                                    const Hash256& tx_hash) {
+    auto& state = shards[shard_id];
+    uint64_t& balance = state->balances[from];
+    balance += amount;
+    state->record_balance(from, balance);
+    state->recent_transactions.erase(tx_hash);  // uygulanmadı: yeniden gönderilebilir
+    ++state->counters.refunded;
+}
+
+size_t FractalSharding::process_acks(uint32_t from_shard, std::vector<uint64_t>* rolled_back) {
+    if (from_shard >= SHARD_COUNT) {
+        return 0;
+    }
     
-    auto& shard = shards[shard_id];
+    std::lock_guard<std::mutex> consumer(ack_consumer[from_shard]);
+    
+    std::vector<CrossShardAck> drained;
+    CrossShardAck ack;
+    while (acks[from_shard].pop(ack)) {
+        drained.push_back(ack);
+    }
+    
+    if (drained.empty()) {
+        return 0;
+    }
+    
+    size_t settled = 0;
+    size_t refunds = 0;
+    
+    {
+        auto lock = lock_shard(from_shard);
+        
+        auto& from_state = shards[from_shard];
+        for (const auto& a : drained) {
+            auto it = from_state->pending_debits.find(a.sequence);
+            if (it == from_state->pending_debits.end()) {
+                continue;
+            }
+            
+            if (!a.accepted) {
+                // Rollback: borç gönderene iade edilir
+                const auto& m = it->second;
+                refund_sender(from_shard, m.from, m.amount + m.fee, m.tx_hash);
+                
+                if (rolled_back) {
+                    rolled_back->push_back(a.tag);
+                }
+                ++refunds;
+            }
+            
+            from_state->pending_debits.erase(it);
+            ++settled;
+        }
+    }
     
-    // Balance check
-    if (shard->balances[tx.from] < tx.amount + tx.fee) {
+    in_flight.fetch_sub(settled, std::memory_order_acq_rel);
+    
+    return refunds;
+}
+
+size_t FractalSharding::pump_cross_shard() {
+    size_t delivered = 0;
+    for (uint32_t i = 0; i < SHARD_COUNT; ++i) {
+        delivered += deliver_cross_shard(i);
+    }
+    for (uint32_t i = 0; i < SHARD_COUNT; ++i) {
+        process_acks(i);
+    }
+    return delivered;
+}
+
+bool FractalSharding::update_shard_state(uint32_t shard_id, const Transaction& tx) {
+    if (shard_id >= SHARD_COUNT) {
         return false;
     }
     
-    // Update balances
-    shard->balances[tx.from] -= (tx.amount + tx.fee);
-    shard->balances[tx.to] += tx.amount;
+    auto lock = lock_shard(shard_id);
     
-    // Update transaction count
-    shard->transaction_count++;
+    // Çağıran eski bir rotayla geldiyse (bölge taşındı) yeniden yönlendir
+    if (assign_shard(tx.from) != shard_id || assign_shard(tx.to) != shard_id) {
+        lock.unlock();
+        return route_transaction(tx);
+    }
+    
+    shard_load[shard_id].fetch_add(1, std::memory_order_relaxed);
+    return apply_local(shard_id, tx);
+}
+
+bool FractalSharding::apply_local(uint32_t shard_id, const Transaction& tx) {
+    auto& shard = shards[shard_id];
     
-    // Add to recent transactions
     QuantumCrypto crypto;
     Hash256 tx_hash = tx.compute_hash(crypto);
-    shard->recent_transactions.push_back(tx_hash);
+    if (shard->recent_transactions.contains(tx_hash)) {
+        ++shard->counters.duplicates;
+        return false;
+    }
     
-    // Keep only last 1000 transactions
-    if (shard->recent_transactions.size() > 1000) {
-        shard->recent_transactions.erase(shard->recent_transactions.begin());
+    // Balance check (bilinmeyen gönderen için kayıt açılmaz). Sıcak gönderen
+    // yetmiyorsa önce bu shard'ın kendisine biriktirdiği krediler katılır.
+    auto sender = shard->balances.find(tx.from);
+    if ((sender == shard->balances.end() || sender->second < tx.amount + tx.fee) &&
+        absorb_delta(*shard, tx.from, shard_id)) {
+        sender = shard->balances.find(tx.from);
+    }
+    if (sender == shard->balances.end() || sender->second < tx.amount + tx.fee) {
+        ++shard->counters.failed;
+        return false;
     }
     
-    // Update state root
-    std::vector<uint8_t> state_data;
-    for (const auto& [addr, balance] : shard->balances) {
-        state_data.insert(state_data.end(), addr.begin(), addr.end());
-        uint8_t bal_bytes[8];
-        std::memcpy(bal_bytes, &balance, 8);
-        state_data.insert(state_data.end(), bal_bytes, bal_bytes + 8);
+    // Sıcak alıcı: yalnızca borç kesin uygulanır, kredi delta bloğuna
+    if (credit_hot(shard_id, tx.to, tx.amount)) {
+        sender->second -= (tx.amount + tx.fee);
+        shard->record_balance(tx.from, sender->second);
+    } else {
+        // Alıcı taşarsa reddedilir (kendine transfer bakiyeyi artıramaz)
+        if (tx.to != tx.from) {
+            auto receiver = shard->balances.find(tx.to);
+            uint64_t current = receiver == shard->balances.end() ? 0 : receiver->second;
+            uint64_t limit = std::numeric_limits<uint64_t>::max() - hot_reserve(tx.to);
+            if (tx.amount > limit || current > limit - tx.amount) {
+                ++shard->counters.failed;
+                return false;
+            }
+        }
+        
+        // Update balances
+        uint64_t from_balance = (sender->second -= (tx.amount + tx.fee));
+        uint64_t to_balance = (shard->balances[tx.to] += tx.amount);  // rehash edebilir, sender geçersiz
+        
+        // Yalnızca dokunulan yollar kirlenir; kök commit_state_roots'ta hesaplanır
+        shard->record_balance(tx.from, from_balance);
+        shard->record_balance(tx.to, to_balance);
+        shard->note_credit(tx.to);
+        shard->touches.add(tx.to);
     }
+    shard->touches.add(tx.from);
+    
+    // Update transaction count
+    shard->transaction_count++;
+    ++shard->counters.applied;
     
-    shard->state_root = crypto.hash(state_data.data(), state_data.size());
+    // Tekrar penceresi: en eski hash halkadan ve indeksten düşer
+    shard->recent_transactions.insert(tx_hash);
     
     return true;
 }
@@ -699,5 +1948,791 @@ const ShardState* FractalSharding::get_shard_state(uint32_t shard_id) const {
     return shards[shard_id].get();
 }
 
-} // namespace HyperLayer
+template <typename AddressOf, typename Fn>
+void FractalSharding::for_each_owned(size_t count, AddressOf address_of, Fn fn) {
+    // Slota göre sayma sıralaması: grup içinde indeks sırası korunur
+    std::vector<uint32_t> owner(count);
+    std::vector<uint32_t> offsets(SHARD_COUNT + 1, 0);
+    for (size_t i = 0; i < count; ++i) {
+        owner[i] = assign_shard(address_of(i));
+        ++offsets[owner[i] + 1];
+    }
+    for (uint32_t s = 0; s < SHARD_COUNT; ++s) {
+        offsets[s + 1] += offsets[s];
+    }
+    std::vector<uint32_t> order(count);
+    std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+    for (size_t i = 0; i < count; ++i) {
+        order[cursor[owner[i]]++] = static_cast<uint32_t>(i);
+    }
+    
+    std::vector<uint32_t> moved;
+    for (uint32_t shard_id = 0; shard_id < SHARD_COUNT; ++shard_id) {
+        if (offsets[shard_id] == offsets[shard_id + 1]) {
+            continue;
+        }
+        
+        auto lock = lock_shard(shard_id);
+        for (uint32_t k = offsets[shard_id]; k < offsets[shard_id + 1]; ++k) {
+            uint32_t i = order[k];
+            if (assign_shard(address_of(i)) == shard_id) {
+                fn(*shards[shard_id], i);
+            } else {
+                moved.push_back(i);
+            }
+        }
+    }
+    
+    for (uint32_t i : moved) {
+        uint32_t shard_id;
+        auto lock = lock_owner(address_of(i), shard_id);
+        fn(*shards[shard_id], i);
+    }
+}
+
+bool FractalSharding::recently_applied(const Address& from, const Hash256& tx_hash) {
+    uint32_t shard_id;
+    auto lock = lock_owner(from, shard_id);
+    return shards[shard_id]->recent_transactions.contains(tx_hash);
+}
+
+void FractalSharding::recently_applied(const std::vector<Address>& from, const std::vector<Hash256>& hashes,
+                                       std::vector<uint8_t>& seen) {
+    seen.assign(from.size(), 0);
+    for_each_owned(from.size(),
+        [&from](size_t i) -> const Address& { return from[i]; },
+        [&](ShardState& shard, uint32_t i) {
+            seen[i] = shard.recent_transactions.contains(hashes[i]) ? 1 : 0;
+        });
+}
+
+void FractalSharding::record_applied(const std::vector<Transaction>& batch, const std::vector<Hash256>& hashes,
+                                     const std::vector<uint8_t>& applied, const std::vector<uint8_t>& replay) {
+    // Kaynak tarafı: debit_sender/apply_local ile aynı sayaçlar
+    std::vector<uint32_t> credited;
+    for_each_owned(batch.size(),
+        [&batch](size_t i) -> const Address& { return batch[i].from; },
+        [&](ShardState& shard, uint32_t i) {
+            const Transaction& tx = batch[i];
+            if (replay[i]) {
+                ++shard.counters.duplicates;
+                return;
+            }
+            if (!applied[i]) {
+                ++shard.counters.failed;
+                return;
+            }
+            
+            shard.recent_transactions.insert(hashes[i]);
+            ++shard.counters.applied;
+            shard.touches.add(tx.from);
+            if (assign_shard(tx.to) == shard.shard_id) {
+                shard.touches.add(tx.to);
+            } else {
+                ++shard.counters.cross_out;
+                credited.push_back(i);
+            }
+        });
+    
+    // Hedef tarafı: apply_credit gibi (STM taşmayı zaten reddetti)
+    for_each_owned(credited.size(),
+        [&](size_t k) -> const Address& { return batch[credited[k]].to; },
+        [&](ShardState& shard, uint32_t k) {
+            ++shard.counters.cross_in;
+            shard.touches.add(batch[credited[k]].to);
+        });
+}
+
+void FractalSharding::mint(const Address& addr, uint64_t amount) {
+    uint32_t shard_id;
+    auto lock = lock_owner(addr, shard_id);
+    
+    auto& shard = shards[shard_id];
+    shard->balances[addr] += amount;
+    shard->record_balance(addr, shard->balances[addr]);
+}
+
+uint64_t FractalSharding::balance_of(const Address& addr) {
+    uint32_t shard_id;
+    auto lock = lock_owner(addr, shard_id);
+    
+    auto& balances = shards[shard_id]->balances;
+    auto it = balances.find(addr);
+    return it == balances.end() ? 0 : it->second;
+}
+
+void FractalSharding::balances_of(const std::vector<Address>& addrs, std::vector<uint64_t>& out) {
+    out.assign(addrs.size(), 0);
+    for_each_owned(addrs.size(),
+        [&addrs](size_t i) -> const Address& { return addrs[i]; },
+        [&](ShardState& shard, uint32_t i) {
+            auto it = shard.balances.find(addrs[i]);
+            out[i] = it == shard.balances.end() ? 0 : it->second;
+        });
+}
+
+void FractalSharding::commit_balances(const std::vector<std::pair<Address, uint64_t>>& balances) {
+    for_each_owned(balances.size(),
+        [&balances](size_t i) -> const Address& { return balances[i].first; },
+        [&](ShardState& shard, uint32_t i) {
+            const auto& [addr, balance] = balances[i];
+            shard_load[shard.shard_id].fetch_add(1, std::memory_order_relaxed);
+            shard.balances[addr] = balance;
+            shard.record_balance(addr, balance);
+        });
+}
+
+void FractalSharding::restore_balances(const std::vector<std::pair<Address, uint64_t>>& balances) {
+    for (const auto& [addr, balance] : balances) {
+        uint32_t shard_id;
+        auto lock = lock_owner(addr, shard_id);
+        
+        auto& shard = shards[shard_id];
+        if (balance == 0) {
+            shard->balances.erase(addr);
+        } else {
+            shard->balances[addr] = balance;
+        }
+        shard->record_balance(addr, balance);
+    }
+}
 
+bool FractalSharding::credit_hot(uint32_t block, const Address& to, uint64_t amount) {
+    if (hot_index.empty()) {
+        return false;
+    }
+    auto it = hot_index.find(to);
+    if (it == hot_index.end()) {
+        return false;
+    }
+    
+    DeltaSlot& slot = credit_deltas[block].slots[it->second];
+    if (amount > hot_accounts[it->second].block_cap - slot.total) {
+        return false;
+    }
+    slot.amount += amount;
+    slot.total += amount;
+    ++slot.credits;
+    return true;
+}
+
+uint64_t FractalSharding::hot_reserve(const Address& addr) const {
+    if (hot_index.empty()) {
+        return 0;
+    }
+    auto it = hot_index.find(addr);
+    return it == hot_index.end() ? 0 : hot_accounts[it->second].reserved;
+}
+
+bool FractalSharding::absorb_delta(ShardState& shard, const Address& addr, uint32_t block) {
+    if (hot_index.empty()) {
+        return false;
+    }
+    auto it = hot_index.find(addr);
+    if (it == hot_index.end()) {
+        return false;
+    }
+    
+    DeltaSlot& slot = credit_deltas[block].slots[it->second];
+    if (slot.amount == 0) {
+        return false;
+    }
+    
+    // Taşma yok: blokların toplamı reserved ile sınırlı
+    uint64_t balance = (shard.balances[addr] += slot.amount);
+    shard.record_balance(addr, balance);
+    slot.amount = 0;
+    return true;
+}
+
+void FractalSharding::flush_credit_deltas() {
+    // 1) Sıcak hesap başına tüm blokların kredisi tek yazımda
+    std::vector<uint64_t> credits(hot_accounts.size(), 0);
+    for (uint32_t h = 0; h < hot_accounts.size(); ++h) {
+        uint64_t amount = 0;
+        for (uint32_t b = 0; b < SHARD_COUNT; ++b) {
+            DeltaSlot& slot = credit_deltas[b].slots[h];
+            amount += slot.amount;
+            credits[h] += slot.credits;
+            slot = DeltaSlot{};
+        }
+        
+        if (credits[h] > 0) {
+            const Address& addr = hot_accounts[h].addr;
+            uint32_t shard_id;
+            auto lock = lock_owner(addr, shard_id);
+            
+            auto& shard = shards[shard_id];
+            if (amount > 0) {
+                uint64_t balance = (shard->balances[addr] += amount);
+                shard->record_balance(addr, balance);
+            }
+            // Borç kontrolünde katılmış olanlar dahil, bu batch'in tüm kredileri
+            shard->counters.hot_credits += credits[h];
+            shard->touches.add(addr, credits[h]);
+        }
+    }
+    
+    // 2) Sıcak küme: hâlâ yoğun kredi alanlar kalır, eşiği geçen adaylar eklenir
+    std::vector<Address> next;
+    if (hot_threshold > 0) {
+        for (uint32_t h = 0; h < hot_accounts.size(); ++h) {
+            if (credits[h] >= hot_threshold / 4) {
+                next.push_back(hot_accounts[h].addr);
+            }
+        }
+    }
+    
+    std::vector<ShardState::CreditCandidate> candidates;
+    for (uint32_t i = 0; i < SHARD_COUNT; ++i) {
+        std::lock_guard<std::mutex> lock(shard_mutexes[i]);
+        for (auto& slot : shards[i]->credit_candidates) {
+            if (hot_threshold > 0 && slot.count >= hot_threshold) {
+                candidates.push_back(slot);
+            }
+            slot.count = 0;
+        }
+    }
+    std::sort(candidates.begin(), candidates.end(),
+        [](const ShardState::CreditCandidate& a, const ShardState::CreditCandidate& b) {
+            return a.count != b.count ? a.count > b.count : a.addr < b.addr;
+        });
+    for (const auto& candidate : candidates) {
+        if (next.size() >= HOT_ACCOUNT_LIMIT) {
+            break;
+        }
+        if (std::find(next.begin(), next.end(), candidate.addr) == next.end()) {
+            next.push_back(candidate.addr);
+        }
+    }
+    
+    // 3) Taşma payı: bloklar toplamda bakiyeyi uint64 sınırına taşıyamaz
+    hot_accounts.clear();
+    hot_index.clear();
+    for (const auto& addr : next) {
+        uint64_t block_cap = (std::numeric_limits<uint64_t>::max() - balance_of(addr)) / SHARD_COUNT;
+        hot_index[addr] = static_cast<uint32_t>(hot_accounts.size());
+        hot_accounts.push_back(HotAccount{addr, block_cap, block_cap * SHARD_COUNT});
+    }
+}
+
+void FractalSharding::set_hot_credit_threshold(uint32_t credits_per_batch) {
+    hot_threshold = credits_per_batch;
+}
+
+void FractalSharding::commit_state_roots() {
+    for (uint32_t i = 0; i < SHARD_COUNT; ++i) {
+        std::lock_guard<std::mutex> lock(shard_mutexes[i]);
+        
+        auto& shard = shards[i];
+        if (shard->state_tree.is_dirty()) {
+            shard->state_root = shard->state_tree.root();
+        }
+    }
+}
+
+bool FractalSharding::split_shard(uint32_t parent, uint32_t child, size_t& moved) {
+    std::scoped_lock lock(shard_mutexes[parent], shard_mutexes[child]);
+    
+    auto& from = shards[parent];
+    auto& to = shards[child];
+    
+    // Ack bekleyen borç varken taşıma yapılmaz (iade yanlış slota düşer)
+    if (!from->pending_debits.empty() || !to->pending_debits.empty()) {
+        return false;
+    }
+    
+    uint32_t depth = regions[parent].depth + 1;
+    uint32_t left = regions[parent].prefix << 1;
+    uint32_t right = left | 1;
+    uint32_t shift = SHARD_ROUTE_BITS - depth;
+    
+    // Sağ yarıya düşen hesaplar çocuk slota taşınır
+    std::vector<std::pair<Address, uint64_t>> moving;
+    for (const auto& [addr, balance] : from->balances) {
+        if ((route_index(addr) >> shift) == right) {
+            moving.emplace_back(addr, balance);
+        }
+    }
+    
+    for (const auto& [addr, balance] : moving) {
+        from->balances.erase(addr);
+        from->record_balance(addr, 0);
+        to->balances[addr] = balance;
+        to->record_balance(addr, balance);
+    }
+    
+    to->transaction_count = 0;
+    
+    // Hash'in göndereni bilinmez: pencere iki yarıya da kopyalanır ki taşınan
+    // hesapların son tx'leri tekrar olarak reddedilmeye devam etsin
+    to->recent_transactions.clear();
+    for (const auto& tx_hash : from->recent_transactions.recent()) {
+        to->recent_transactions.insert(tx_hash);
+    }
+    to->counters = ShardCounters();
+    to->touches.clear();
+    
+    regions[parent] = ShardRegion{depth, left, true};
+    regions[child] = ShardRegion{depth, right, true};
+    assign_range(depth, right, child);
+    ++topology_version;
+    
+    moved = moving.size();
+    return true;
+}
+
+bool FractalSharding::merge_shards(uint32_t keep, uint32_t drop, size_t& moved) {
+    std::scoped_lock lock(shard_mutexes[keep], shard_mutexes[drop]);
+    
+    auto& into = shards[keep];
+    auto& from = shards[drop];
+    
+    if (!into->pending_debits.empty() || !from->pending_debits.empty()) {
+        return false;
+    }
+    
+    // Kardeş bölgeler ayrık: hesaplar çakışmaz
+    moved = 0;
+    for (const auto& [addr, balance] : from->balances) {
+        into->balances[addr] = balance;
+        into->record_balance(addr, balance);
+        from->record_balance(addr, 0);
+        ++moved;
+    }
+    from->balances.clear();
+    
+    into->transaction_count += from->transaction_count;
+    from->transaction_count = 0;
+    for (const auto& tx_hash : from->recent_transactions.recent()) {
+        into->recent_transactions.insert(tx_hash);
+    }
+    from->recent_transactions.clear();
+    
+    // Telemetri birleşir; sketch girdileri sayılarıyla aktarılır
+    into->counters += from->counters;
+    for (const auto& entry : from->touches.top()) {
+        into->touches.add(entry.addr, entry.count);
+    }
+    from->counters = ShardCounters();
+    from->touches.clear();
+    
+    uint32_t depth = regions[keep].depth - 1;
+    uint32_t prefix = regions[keep].prefix >> 1;
+    regions[keep] = ShardRegion{depth, prefix, true};
+    regions[drop] = ShardRegion{0, 0, false};
+    assign_range(depth, prefix, keep);
+    ++topology_version;
+    
+    return true;
+}
+
+ShardRebalanceResult FractalSharding::rebalance(double split_factor, double merge_factor) {
+    std::lock_guard<std::mutex> topology(topology_mutex);
+    
+    ShardRebalanceResult result;
+    std::array<uint64_t, SHARD_COUNT> load;
+    std::vector<uint64_t> active_loads;
+    
+    for (uint32_t i = 0; i < SHARD_COUNT; ++i) {
+        load[i] = shard_load[i].exchange(0, std::memory_order_relaxed);
+        if (regions[i].active) {
+            active_loads.push_back(load[i]);
+        }
+    }
+    
+    uint64_t total = 0;
+    for (uint64_t l : active_loads) {
+        total += l;
+    }
+    
+    // Çok az ölçüm varsa karar verme
+    if (total < SHARD_COUNT * 4) {
+        result.active_shards = static_cast<uint32_t>(active_loads.size());
+        return result;
+    }
+    
+    std::nth_element(active_loads.begin(), active_loads.begin() + active_loads.size() / 2, active_loads.end());
+    double median = std::max<double>(1.0, static_cast<double>(active_loads[active_loads.size() / 2]));
+    
+    std::array<bool, SHARD_COUNT> touched{};
+    
+    // Bölme: en sıcak yapraktan başla, boş slot kaldıkça
+    std::vector<uint32_t> hot;
+    for (uint32_t i = 0; i < SHARD_COUNT; ++i) {
+        if (regions[i].active && regions[i].depth < SHARD_ROUTE_BITS && load[i] > split_factor * median) {
+            hot.push_back(i);
+        }
+    }
+    std::sort(hot.begin(), hot.end(), [&](uint32_t a, uint32_t b) {
+        return load[a] != load[b] ? load[a] > load[b] : a < b;
+    });
+    
+    uint32_t free_slot = 0;
+    for (uint32_t parent : hot) {
+        while (free_slot < SHARD_COUNT && regions[free_slot].active) {
+            ++free_slot;
+        }
+        if (free_slot == SHARD_COUNT) {
+            break;
+        }
+        
+        size_t moved = 0;
+        if (split_shard(parent, free_slot, moved)) {
+            touched[parent] = touched[free_slot] = true;
+            result.accounts_moved += moved;
+            ++result.splits;
+        }
+    }
+    
+    // Birleştirme: sol çocuk (prefix biti 0) kalır, sağ kardeş ona katılır
+    std::unordered_map<uint64_t, uint32_t> leaf_of;
+    for (uint32_t i = 0; i < SHARD_COUNT; ++i) {
+        if (regions[i].active) {
+            leaf_of[(static_cast<uint64_t>(regions[i].depth) << 32) | regions[i].prefix] = i;
+        }
+    }
+    
+    for (uint32_t keep = 0; keep < SHARD_COUNT; ++keep) {
+        const ShardRegion region = regions[keep];
+        if (!region.active || touched[keep] || region.depth <= 1 || (region.prefix & 1)) {
+            continue;
+        }
+        
+        auto sibling = leaf_of.find((static_cast<uint64_t>(region.depth) << 32) | (region.prefix | 1));
+        if (sibling == leaf_of.end()) {
+            continue;
+        }
+        
+        uint32_t drop = sibling->second;
+        if (touched[drop] || load[keep] + load[drop] >= merge_factor * median) {
+            continue;
+        }
+        
+        size_t moved = 0;
+        if (merge_shards(keep, drop, moved)) {
+            touched[keep] = touched[drop] = true;
+            result.accounts_moved += moved;
+            ++result.merges;
+        }
+    }
+    
+    for (uint32_t i = 0; i < SHARD_COUNT; ++i) {
+        result.active_shards += regions[i].active ? 1 : 0;
+    }
+    
+    return result;
+}
+
+uint32_t FractalSharding::active_shard_count() const {
+    std::lock_guard<std::mutex> topology(topology_mutex);
+    
+    uint32_t count = 0;
+    for (const auto& region : regions) {
+        count += region.active ? 1 : 0;
+    }
+    return count;
+}
+
+bool FractalSharding::shard_region(uint32_t shard_id, uint32_t& depth, uint32_t& prefix) const {
+    if (shard_id >= SHARD_COUNT) {
+        return false;
+    }
+    
+    std::lock_guard<std::mutex> topology(topology_mutex);
+    depth = regions[shard_id].depth;
+    prefix = regions[shard_id].prefix;
+    return regions[shard_id].active;
+}
+
+TelemetrySnapshot FractalSharding::telemetry(bool reset) {
+    // Topoloji kilidi: bölgeler okunurken böl/birleştir olmaz
+    std::lock_guard<std::mutex> topology(topology_mutex);
+    
+    TelemetrySnapshot out;
+    for (uint32_t i = 0; i < SHARD_COUNT; ++i) {
+        if (!regions[i].active) {
+            continue;
+        }
+        
+        ShardTelemetry t;
+        t.shard_id = i;
+        t.active = true;
+        t.depth = regions[i].depth;
+        t.prefix = regions[i].prefix;
+        t.load = shard_load[i].load(std::memory_order_relaxed);
+        {
+            std::lock_guard<std::mutex> lock(shard_mutexes[i]);
+            auto& shard = shards[i];
+            t.account_count = shard->balances.size();
+            t.pending_debits = shard->pending_debits.size();
+            t.counters = shard->counters;
+            t.hot_accounts = shard->touches.top();
+            t.touches = shard->touches.total_weight();
+            
+            if (reset) {
+                shard->counters = ShardCounters();
+                shard->touches.clear();
+            }
+        }
+        
+        out.totals += t.counters;
+        out.shards.push_back(std::move(t));
+    }
+    
+    out.cross_shard_in_flight = cross_shard_in_flight();
+    out.hot_credit_accounts = hot_accounts.size();
+    return out;
+}
+
+// ============================================================================
+// MVCC STATE GÖRÜNTÜLERİ İMPLEMENTASYONU
+// ============================================================================
+
+namespace {
+
+// std::array'in operator< sırasıyla aynı (işaretsiz bayt sözlük sırası). Rastgele
+// adreslerde ilk 8 bayt neredeyse her zaman karar verir; onlar tek karşılaştırmada.
+bool address_less(const std::pair<Address, uint64_t>& entry, const Address& addr) {
+    uint64_t a, b;
+    std::memcpy(&a, entry.first.data(), 8);
+    std::memcpy(&b, addr.data(), 8);
+    if (a != b) {
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        a = __builtin_bswap64(a);
+        b = __builtin_bswap64(b);
+#endif
+        return a < b;
+    }
+    return std::memcmp(entry.first.data() + 8, addr.data() + 8, addr.size() - 8) < 0;
+}
+
+const std::shared_ptr<const ShardSnapshot::Bucket>& empty_bucket() {
+    static const std::shared_ptr<const ShardSnapshot::Bucket> bucket =
+        std::make_shared<const ShardSnapshot::Bucket>();
+    return bucket;
+}
+
+} // namespace
+
+uint32_t ShardSnapshot::bucket_of(const Address& addr) {
+    // route_index üst, FlatMap alt bitleri kullanır; kova orta bitlerden
+    return static_cast<uint32_t>((static_cast<uint64_t>(AddressHash()(addr)) >> 24) % SNAPSHOT_BUCKETS);
+}
+
+bool ShardSnapshot::find(const Address& addr, uint64_t& balance) const {
+    const Bucket& bucket = *buckets[bucket_of(addr)];
+    auto it = std::lower_bound(bucket.begin(), bucket.end(), addr, address_less);
+    if (it == bucket.end() || it->first != addr) {
+        return false;
+    }
+    balance = it->second;
+    return true;
+}
+
+uint32_t StateSnapshot::shard_of(const Address& addr) const {
+    return (*routes)[static_cast<uint64_t>(AddressHash()(addr)) >> (64 - SHARD_ROUTE_BITS)];
+}
+
+uint64_t StateSnapshot::balance_of(const Address& addr) const {
+    uint64_t balance = 0;
+    shards[shard_of(addr)]->find(addr, balance);
+    return balance;
+}
+
+bool FractalSharding::publish_snapshots(uint64_t height) {
+    std::lock_guard<std::mutex> publisher(publish_mutex);
+    
+    // 1) Kirli root'lar shard başına kilitle hesaplanır (pahalı kısım)
+    for (uint32_t i = 0; i < SHARD_COUNT; ++i) {
+        std::lock_guard<std::mutex> lock(shard_mutexes[i]);
+        auto& shard = shards[i];
+        if (shard->state_tree.is_dirty()) {
+            shard->state_root = shard->state_tree.root();
+        }
+    }
+    
+    // 2) Kesit topoloji ve tüm shard kilitleri (bu sırayla, artan slot) tutularak
+    //    alınır: shard'lar ve rotalar için tek bir an. Yolda cross-shard mesaj
+    //    ya da işlenmemiş sıcak kredi varsa borç görünür ama kredi görünmez;
+    //    batch sınırında değiliz demektir ve görüntü yayınlanmaz.
+    std::shared_ptr<const StateSnapshot> previous = std::atomic_load(&current_snapshot);
+    auto next = std::make_shared<StateSnapshot>();
+    next->height = height;
+    
+    std::vector<std::vector<std::pair<Address, uint64_t>>> changes_of(SHARD_COUNT);
+    std::vector<Hash256> roots(SHARD_COUNT);
+    std::vector<uint64_t> transaction_counts(SHARD_COUNT);
+    {
+        std::lock_guard<std::mutex> topology(topology_mutex);
+        std::vector<std::unique_lock<std::mutex>> locks;
+        locks.reserve(SHARD_COUNT);
+        for (uint32_t i = 0; i < SHARD_COUNT; ++i) {
+            locks.emplace_back(shard_mutexes[i]);
+        }
+        
+        if (in_flight.load(std::memory_order_acquire) > 0) {
+            return false;
+        }
+        for (uint32_t b = 0; b < SHARD_COUNT; ++b) {
+            for (const DeltaSlot& slot : credit_deltas[b].slots) {
+                if (slot.credits > 0) {
+                    return false;
+                }
+            }
+        }
+        
+        for (uint32_t i = 0; i < SHARD_COUNT; ++i) {
+            auto& shard = shards[i];
+            if (shard->state_tree.is_dirty()) {
+                shard->state_root = shard->state_tree.root();
+            }
+            changes_of[i].swap(shard->snapshot_changes);
+            roots[i] = shard->state_root;
+            transaction_counts[i] = shard->transaction_count;
+        }
+        
+        // Shard haritası yalnızca bölme/birleştirme sonrası kopyalanır
+        if (previous && published_topology_version == topology_version) {
+            next->routes = previous->routes;
+        } else {
+            auto routes = std::make_shared<StateSnapshot::RouteTable>();
+            for (size_t i = 0; i < routes->size(); ++i) {
+                (*routes)[i] = route_table[i].load(std::memory_order_acquire);
+            }
+            next->routes = routes;
+            published_topology_version = topology_version;
+        }
+    }
+    
+    std::vector<Address> journal_addresses;
+    
+    for (uint32_t i = 0; i < SHARD_COUNT; ++i) {
+        const auto& changes = changes_of[i];
+        const Hash256& root = roots[i];
+        uint64_t transaction_count = transaction_counts[i];
+        
+        if (journal) {
+            for (const auto& change : changes) {
+                journal_addresses.push_back(change.first);
+            }
+        }
+        
+        const ShardSnapshot* prev = previous ? previous->shards[i].get() : nullptr;
+        if (prev && changes.empty() && prev->transaction_count == transaction_count) {
+            next->shards[i] = previous->shards[i];
+            continue;
+        }
+        
+        auto snap = std::make_shared<ShardSnapshot>();
+        snap->shard_id = i;
+        snap->height = height;
+        snap->state_root = root;
+        snap->transaction_count = transaction_count;
+        if (prev) {
+            snap->buckets = prev->buckets;
+        } else {
+            snap->buckets.fill(empty_bucket());
+        }
+        
+        // Adres başına son değer kazanır; kova içinde tek geçişte birleştirilir.
+        // Kova numarası sıralamadan önce bir kez hesaplanır.
+        std::vector<std::pair<uint32_t, uint32_t>> order(changes.size());
+        for (size_t k = 0; k < changes.size(); ++k) {
+            order[k] = {ShardSnapshot::bucket_of(changes[k].first), static_cast<uint32_t>(k)};
+        }
+        std::stable_sort(order.begin(), order.end(),
+            [&changes](const std::pair<uint32_t, uint32_t>& a, const std::pair<uint32_t, uint32_t>& b) {
+                return a.first != b.first ? a.first < b.first
+                                          : address_less(changes[a.second], changes[b.second].first);
+            });
+        
+        size_t c = 0;
+        while (c < order.size()) {
+            uint32_t bucket_id = order[c].first;
+            const auto& old_bucket = *snap->buckets[bucket_id];
+            auto merged = std::make_shared<ShardSnapshot::Bucket>();
+            merged->reserve(old_bucket.size() + 4);
+            
+            size_t o = 0;
+            while (c < order.size() && order[c].first == bucket_id) {
+                const Address& addr = changes[order[c].second].first;
+                while (c + 1 < order.size() && changes[order[c + 1].second].first == addr) {
+                    ++c;
+                }
+                
+                while (o < old_bucket.size() && address_less(old_bucket[o], addr)) {
+                    merged->push_back(old_bucket[o++]);
+                }
+                if (o < old_bucket.size() && old_bucket[o].first == addr) {
+                    ++o;
+                }
+                if (changes[order[c].second].second != 0) {
+                    merged->push_back(changes[order[c].second]);
+                }
+                ++c;
+            }
+            while (o < old_bucket.size()) {
+                merged->push_back(old_bucket[o++]);
+            }
+            
+            snap->buckets[bucket_id] = std::move(merged);
+        }
+        
+        snap->account_count = 0;
+        for (const auto& bucket : snap->buckets) {
+            snap->account_count += bucket->size();
+        }
+        next->shards[i] = std::move(snap);
+    }
+    
+    // Log kaydı görüntü yayınlanmadan önce: adres başına son bakiye yeni
+    // görüntüden okunur (taşınan hesabın eski shard'daki 0 kaydı önemsiz)
+    if (journal) {
+        std::sort(journal_addresses.begin(), journal_addresses.end());
+        journal_addresses.erase(std::unique(journal_addresses.begin(), journal_addresses.end()),
+                                journal_addresses.end());
+        
+        std::vector<std::pair<Address, uint64_t>> record;
+        record.reserve(journal_addresses.size());
+        for (const auto& addr : journal_addresses) {
+            record.emplace_back(addr, next->balance_of(addr));
+        }
+        journal->append(height, record);
+    }
+    
+    std::shared_ptr<const StateSnapshot> published = std::move(next);
+    std::atomic_store(&current_snapshot, published);
+    
+    if (journal && journal->checkpoint_due(height)) {
+        journal->checkpoint(*published);
+    }
+    
+    std::lock_guard<std::mutex> lock(history_mutex);
+    snapshot_history.push_back(published);
+    if (snapshot_history.size() > SNAPSHOT_HISTORY) {
+        snapshot_history.erase(snapshot_history.begin());
+    }
+    return true;
+}
+
+std::shared_ptr<const StateSnapshot> FractalSharding::snapshot() const {
+    return std::atomic_load(&current_snapshot);
+}
+
+void FractalSharding::attach_journal(WriteAheadLog* wal) {
+    std::lock_guard<std::mutex> publisher(publish_mutex);
+    journal = wal;
+}
+
+std::shared_ptr<const StateSnapshot> FractalSharding::snapshot_at(uint64_t height) const {
+    std::lock_guard<std::mutex> lock(history_mutex);
+    for (auto it = snapshot_history.rbegin(); it != snapshot_history.rend(); ++it) {
+        if ((*it)->height == height) {
+            return *it;
+        }
+    }
+    return nullptr;
+}
+
+} // namespace HyperLayer
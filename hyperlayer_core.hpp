@@ -8,14 +8,29 @@
 #include <cstdint>
 #include <vector>
 #include <string>
+#include <string_view>
+#include <iosfwd>
 #include <memory>
 #include <chrono>
 #include <array>
 #include <unordered_map>
+#include <map>
 #include <queue>
 #include <mutex>
 #include <thread>
 #include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <functional>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 namespace HyperLayer {
 
@@ -33,13 +48,87 @@ using Address = std::array<uint8_t, 20>;
 constexpr uint64_t NANOSECOND_PRECISION = 1000000000;
 constexpr uint32_t MAX_TRANSACTION_SIZE = 1024 * 1024;
 constexpr uint32_t BLOCK_TIME_TARGET_NS = 100000000;
-constexpr uint32_t SHARD_COUNT = 256;
+constexpr uint32_t SHARD_COUNT = 256;          // shard slot sayısı (aktif + boş)
+constexpr uint32_t SHARD_ROUTE_BITS = 16;      // shard haritasının en derin seviyesi
+constexpr uint32_t SHARD_INITIAL_DEPTH = 6;    // başlangıçta 2^6 = 64 aktif shard
+constexpr uint32_t SNAPSHOT_BUCKETS = 256;     // shard görüntüsü başına bakiye kovası
+constexpr uint32_t SNAPSHOT_HISTORY = 16;      // saklanan son batch yüksekliği sayısı
+constexpr uint32_t HOT_ACCOUNT_LIMIT = 64;     // aynı anda delta tamponlu sıcak alıcı sayısı
+constexpr uint32_t HOT_CANDIDATE_SLOTS = 64;   // shard başına sıcak alıcı aday sayacı
+constexpr uint32_t HOT_CREDIT_THRESHOLD = 256; // batch başına kredi: bunun üstü sıcak
+constexpr uint32_t HEAVY_HITTER_SLOTS = 16;     // shard başına telemetri sketch kapasitesi
+constexpr uint32_t RECENT_TX_CAPACITY = 1024;   // shard başına tekrar (replay) penceresi, 2'nin kuvveti
 constexpr uint32_t VALIDATOR_MINIMUM = 21;
 
+// std::array anahtarlı unordered_map'ler için hash functor (FNV-1a)
+struct ArrayHash {
+    template <size_t N>
+    size_t operator()(const std::array<uint8_t, N>& arr) const noexcept {
+        uint64_t h = 0xcbf29ce484222325ULL;
+        for (auto byte : arr) {
+            h ^= byte;
+            h *= 0x100000001b3ULL;
+        }
+        return static_cast<size_t>(h);
+    }
+};
+
 // Helper functions
 void secure_random_bytes(uint8_t* buffer, size_t len);
 std::string hash_to_string(const Hash256& hash);
 
+// Onaltılık kodlama, çağıranın tamponuna (heap yok). hex_encode 2*len
+// karakter yazar, sonlandırıcı eklemez. hex_decode len karakterden len/2
+// bayt üretir; büyük/küçük harf kabul eder, tek uzunlukta ya da geçersiz
+// karakterde false döner. SSE2 varsa 16 bayt birden.
+void hex_encode(const uint8_t* data, size_t len, char* out);
+bool hex_decode(const char* hex, size_t len, uint8_t* out);
+
+// Sabit boyutlu onaltılık gösterim: 64 karakter + '\0', tamamı yığında.
+// Log satırları için hash_to_string yerine; doğrudan akışa yazılabilir.
+class HexHash {
+private:
+    std::array<char, 65> chars;
+    
+public:
+    explicit HexHash(const Hash256& hash) {
+        hex_encode(hash.data(), hash.size(), chars.data());
+        chars[64] = '\0';
+    }
+    
+    const char* c_str() const { return chars.data(); }
+    std::string_view view() const { return std::string_view(chars.data(), 64); }
+    // Kısaltılmış gösterim (ör. ilk 16 karakter)
+    std::string_view prefix(size_t count) const { return view().substr(0, count); }
+    std::string str() const { return std::string(view()); }
+    
+    // 64 karakterlik gösterimi çözer; hatalıysa false
+    static bool parse(std::string_view hex, Hash256& out);
+};
+
+std::ostream& operator<<(std::ostream& os, const HexHash& hex);
+
+// Standart base64 (dolgulu); decode geçersiz karakterde ya da uzunlukta false
+std::string base64_encode(const uint8_t* data, size_t len);
+bool base64_decode(std::string_view text, std::vector<uint8_t>& out);
+
+// Küçük JSON tarayıcısı (RPC gövdeleri için): değerler ham metin olarak
+// verilir, dizgeler gerektiğinde json_string_value ile çözülür. fn false
+// dönerse tarama durur. Biçim hatasında false; parantez eşleşmesi yalnızca
+// derinlik olarak izlenir (tam doğrulayıcı değildir).
+bool json_for_each_element(std::string_view array, const std::function<bool(std::string_view)>& fn);
+bool json_for_each_member(std::string_view object,
+                          const std::function<bool(std::string_view key, std::string_view value)>& fn);
+bool json_string_value(std::string_view value, std::string& out);
+
+// SipHash-2-4: anahtarlı 64-bit PRF (kısa transaction ID'leri için)
+uint64_t siphash24(uint64_t k0, uint64_t k1, const uint8_t* data, size_t len);
+
+// [0, count) aralığını iş parçacıklarına böler; count küçükse çağıran
+// thread'de seri çalışır. fn(begin, end) her parça için bir kez çağrılır.
+void parallel_for(size_t count, size_t min_chunk,
+                  const std::function<void(size_t, size_t)>& fn);
+
 // ============================================================================
 // QUANTUM-READY KRİPTOGRAFİ MOTORU
 // ============================================================================
@@ -88,13 +177,13 @@ struct DAGNode {
 
 class MerkleDAG {
 private:
-    std::unordered_map<Hash256, std::shared_ptr<DAGNode>> nodes;
+    std::unordered_map<Hash256, std::shared_ptr<DAGNode>, ArrayHash> nodes;
     std::mutex dag_mutex;
     std::vector<Hash256> topological_order;
     
     bool has_cycle_util(const Hash256& node_id, 
-                       std::unordered_map<Hash256, int>& visited,
-                       std::unordered_map<Hash256, int>& rec_stack);
+                       std::unordered_map<Hash256, int, ArrayHash>& visited,
+                       std::unordered_map<Hash256, int, ArrayHash>& rec_stack);
     
 public:
     MerkleDAG();
@@ -143,6 +232,91 @@ struct Transaction {
     bool verify_signature(QuantumCrypto& crypto) const;
 };
 
+// ============================================================================
+// MERKLE BATCH COMMITMENT
+// ============================================================================
+
+// Bir transaction'ın batch köküne dahil olduğunu gösteren O(log n) kanıt.
+// Kardeşi olmayan (tek sayılı seviyenin son) düğümler bir üst seviyeye
+// aynen taşınır; doğrulayıcı bunu leaf_index ve leaf_count'tan çıkarır.
+struct MerkleProof {
+    uint32_t leaf_index;
+    uint32_t leaf_count;
+    std::vector<Hash256> siblings; // yapraktan köke doğru
+    
+    MerkleProof() : leaf_index(0), leaf_count(0) {}
+};
+
+class BatchMerkleTree {
+private:
+    // levels[0] = yaprak hash'leri, levels.back() = {root}
+    std::vector<std::vector<Hash256>> levels;
+    
+    void build_levels();
+    
+public:
+    BatchMerkleTree();
+    
+    void build(const std::vector<Hash256>& tx_hashes);
+    void build(const std::vector<Transaction>& txs);
+    
+    Hash256 root() const;
+    size_t leaf_count() const;
+    MerkleProof prove(uint32_t leaf_index) const;
+    
+    // Yaprak ve iç düğümler farklı prefix ile hash'lenir (second-preimage koruması)
+    static Hash256 hash_leaf(QuantumCrypto& crypto, const Hash256& tx_hash);
+    static Hash256 hash_inner(QuantumCrypto& crypto, const Hash256& left, const Hash256& right);
+    static bool verify(const Hash256& tx_hash, const MerkleProof& proof, const Hash256& root);
+};
+
+// ============================================================================
+// KOMPAKT PROPOSAL RELAY
+// ============================================================================
+
+// Proposal tam transaction'lar yerine 6 byte'lık tuzlu kısa ID'ler taşır.
+// Alıcı batch'i kendi mempool'undan kurar, yalnızca eksikleri ister.
+constexpr size_t SHORT_TXID_BYTES = 6;
+constexpr uint64_t SHORT_TXID_MASK = (1ULL << (8 * SHORT_TXID_BYTES)) - 1;
+
+struct CompactProposal {
+    Hash256 batch_root;
+    uint64_t salt;                    // proposal başına rastgele
+    std::vector<uint64_t> short_ids;  // batch sırasıyla
+    
+    CompactProposal() : batch_root{0}, salt(0) {}
+    size_t wire_size() const;
+};
+
+struct CompactReconstruction {
+    std::vector<Transaction> txs;     // proposal sırasıyla
+    std::vector<uint32_t> missing;    // mempool'da bulunamayan indeksler
+};
+
+class CompactRelay {
+public:
+    static CompactProposal make_proposal(const std::vector<Hash256>& tx_hashes,
+                                         const Hash256& batch_root,
+                                         uint64_t salt);
+    static uint64_t short_id(const CompactProposal& proposal, const Hash256& tx_hash);
+    
+    // missing boş dönerse batch kökü zaten doğrulanmıştır; kök tutmazsa
+    // (kısa ID çakışması) tüm indeksler missing'e yazılır. missing boş değilse
+    // batch ancak fill_missing true döndükten sonra kabul edilebilir.
+    static CompactReconstruction reconstruct(const CompactProposal& proposal,
+                                             const std::vector<Transaction>& mempool);
+    // Eksikleri (missing sırasıyla) yerleştirir ve batch kökünü doğrular;
+    // kısa ID çakışması kökü bozar ve false döner (tam proposal istenmeli).
+    static bool fill_missing(const CompactProposal& proposal,
+                             CompactReconstruction& reconstruction,
+                             const std::vector<Transaction>& fetched);
+    
+    static size_t full_wire_size(const std::vector<Transaction>& txs);
+    
+private:
+    static void derive_keys(const CompactProposal& proposal, uint64_t& k0, uint64_t& k1);
+};
+
 // ============================================================================
 // ADAPTIVE CONSENSUS MOTORU
 // ============================================================================
@@ -167,11 +341,17 @@ private:
         uint32_t round;
         uint32_t step;
         std::vector<Hash256> proposals;
-        std::unordered_map<Hash256, uint32_t> votes;
+        std::unordered_map<Hash256, uint32_t, ArrayHash> votes;
     };
     
     BFTState bft_state;
     
+    // Son commit edilen batch'in Merkle ağacı (inclusion proof'lar için)
+    BatchMerkleTree last_batch_tree;
+    mutable std::mutex batch_mutex;
+    
+    bool vote_on_batch(BatchMerkleTree& tree, const std::vector<PublicKey>& validators);
+    
 public:
     AdaptiveConsensus();
     
@@ -179,53 +359,1256 @@ public:
     std::vector<PublicKey> select_validators(uint32_t count);
     bool reach_consensus(const std::vector<Transaction>& txs,
                         const std::vector<PublicKey>& validators);
+    // Batch ağacı hazırsa (tx hash'lerinden kurulmuş) doğrudan oylanır
+    bool reach_consensus(BatchMerkleTree&& tree,
+                        const std::vector<PublicKey>& validators);
     ConsensusMode get_current_mode() const { return current_mode; }
+    
+    // Mesaj tabanlı oylama (simülatör ve ağ katmanı için)
+    static uint32_t quorum_size(size_t validator_count);
+    uint32_t record_vote(const Hash256& vote_key);
+    uint32_t get_vote_count(const Hash256& vote_key) const;
+    void clear_votes();
+    
+    Hash256 get_last_batch_root() const;
+    MerkleProof get_inclusion_proof(uint32_t tx_index) const;
+};
+
+// ============================================================================
+// KONSENSÜS SİMÜLATÖRÜ (DISCRETE-EVENT)
+// ============================================================================
+
+enum class ByzantineBehavior : uint8_t {
+    SILENT,      // Hiç mesaj göndermez
+    EQUIVOCATE   // Sahte kök için oy verir, leader iken çelişkili proposal yollar
+};
+
+struct SimulationConfig {
+    uint32_t node_count;
+    uint32_t byzantine_count;
+    ByzantineBehavior byzantine_behavior;
+    
+    uint32_t batch_size;          // proposal başına transaction
+    uint32_t batch_count;         // commit edilecek batch sayısı
+    uint64_t offered_tps;         // AdaptiveConsensus::adjust_mode girdisi
+    
+    double link_latency_ms;       // tek yön ortalama gecikme
+    double link_jitter_ms;        // [0, jitter) uniform ek gecikme
+    double packet_loss;           // mesaj başına kayıp olasılığı
+    double uplink_mbps;           // node başına çıkış bant genişliği
+    double verify_us_per_tx;      // proposal doğrulama CPU maliyeti
+    double view_timeout_ms;       // leader değişimi zaman aşımı
+    
+    bool compact_proposals;       // kısa ID'li proposal + eksik tx fetch
+    double mempool_overlap;       // alıcının mempool'unda olan tx oranı
+    
+    uint64_t seed;
+    
+    SimulationConfig();
+};
+
+struct SimulationReport {
+    ConsensusMode mode;
+    uint32_t committed_batches;
+    uint32_t view_changes;
+    
+    // Batch'in ilk proposal'ından 2f+1 dürüst node'un commit etmesine kadar
+    double latency_p50_ms;
+    double latency_p90_ms;
+    double latency_p99_ms;
+    double latency_max_ms;
+    
+    double throughput_tps;        // simüle edilen zamana göre
+    double simulated_ms;
+    
+    uint64_t messages_sent;
+    uint64_t messages_dropped;
+    uint64_t bytes_sent;
+    uint64_t proposal_bytes;      // yalnızca proposal + eksik tx trafiği
+    double propagation_p50_ms;    // proposal'ın node'da kurulmasına kadar geçen süre
+    
+    SimulationReport();
+};
+
+// Tek process içinde N AdaptiveConsensus instance'ını PBFT mesaj akışıyla
+// (propose / prepare / commit / view-change) çalıştırır. Zaman sanaldır ve
+// tüm rastgelelik seed'den türetilir: aynı config her zaman aynı raporu verir.
+class ConsensusSimulator {
+public:
+    explicit ConsensusSimulator(const SimulationConfig& config);
+    ~ConsensusSimulator();
+    
+    SimulationReport run();
+    
+private:
+    struct Node;
+    struct Message;
+    struct Event;
+    
+    SimulationConfig config;
+    std::vector<std::unique_ptr<Node>> nodes;
+    std::vector<Event> event_heap;
+    uint64_t now_ns;
+    uint64_t event_order;
+    uint64_t rng_state;
+    
+    SimulationReport report;
+    std::vector<uint64_t> batch_start_ns;
+    std::vector<uint32_t> batch_honest_commits;
+    std::vector<double> batch_latencies_ms;
+    std::vector<uint64_t> proposal_sent_ns;
+    std::vector<double> propagation_ms;
+    
+    uint32_t fault_tolerance() const;
+    uint32_t leader_of(uint64_t seq, uint32_t view) const;
+    bool three_phase() const;
+    
+    static bool event_later(const Event& a, const Event& b);
+    double next_uniform();
+    void schedule(const Event& event);
+    void send(uint32_t from, uint32_t to, const Message& msg);
+    void broadcast(uint32_t from, const Message& msg);
+    void arm_timer(uint32_t node_id);
+    
+    void start_sequence(uint32_t node_id);
+    void propose(uint32_t node_id);
+    void handle_message(uint32_t node_id, const Message& msg);
+    void accept_proposal(uint32_t node_id, const Hash256& root);
+    void handle_timer(uint32_t node_id, uint64_t seq, uint32_t view);
+    void try_advance(uint32_t node_id);
+    void commit(uint32_t node_id, const Hash256& root);
+    
+    Hash256 vote_key(uint8_t phase, uint64_t seq, uint32_t view, const Hash256& root) const;
+};
+
+// ============================================================================
+// AÇIK ADRESLEMELİ HASH TABLOSU
+// ============================================================================
+
+// 20 baytlık adresler için hızlı hash: üç yüklemeli çarpımsal karıştırma.
+// Adresler zaten hash türevi olduğundan FNV'nin bayt bayt döngüsü gereksiz.
+struct AddressHash {
+    size_t operator()(const Address& addr) const noexcept {
+        uint64_t w0, w1;
+        uint32_t w2;
+        std::memcpy(&w0, addr.data(), 8);
+        std::memcpy(&w1, addr.data() + 8, 8);
+        std::memcpy(&w2, addr.data() + 16, 4);
+        
+        uint64_t h = w0 * 0x9E3779B97F4A7C15ULL;
+        h ^= (w1 + 0xBF58476D1CE4E5B9ULL) * 0x94D049BB133111EBULL;
+        h ^= (static_cast<uint64_t>(w2) << 32 | (h >> 32)) * 0xD6E8FEB86659FD93ULL;
+        h ^= h >> 32;
+        return static_cast<size_t>(h);
+    }
+};
+
+// Hash256 anahtarlar (tx hash'leri) için: dört kelimenin hepsi karışır
+struct DigestHash {
+    size_t operator()(const Hash256& digest) const noexcept {
+        uint64_t w[4];
+        std::memcpy(w, digest.data(), sizeof(w));
+        
+        uint64_t h = w[0] * 0x9E3779B97F4A7C15ULL;
+        h ^= (w[1] + 0xBF58476D1CE4E5B9ULL) * 0x94D049BB133111EBULL;
+        h ^= (w[2] ^ (h >> 29)) * 0xD6E8FEB86659FD93ULL;
+        h ^= (w[3] + (h >> 32)) * 0x9E3779B97F4A7C15ULL;
+        h ^= h >> 32;
+        return static_cast<size_t>(h);
+    }
+};
+
+// SwissTable tarzı düz (flat) hash tablosu.
+//
+// Her slotun bir kontrol baytı vardır: boş, silinmiş ya da hash'in alt 7
+// bitinden oluşan parmak izi (H2). Arama 16 slotluk grupları SSE2 ile tek
+// karşılaştırmada tarar; anahtar yalnızca parmak izi tutan slotlarda
+// karşılaştırılır. Grup sırası hash'in üst bitlerinden (H1) başlayıp üçgensel
+// ilerler. find() hiçbir zaman ekleme yapmaz; operator[] yazma yoludur.
+// Doluluk 7/8'i geçince kapasite ikiye katlanır.
+template <typename K, typename V, typename Hash = ArrayHash>
+class FlatMap {
+public:
+    using value_type = std::pair<K, V>;
+    
+private:
+    static constexpr size_t GROUP_WIDTH = 16;
+    static constexpr int8_t CTRL_EMPTY = -128;
+    static constexpr int8_t CTRL_DELETED = -2;
+    static constexpr size_t NPOS = static_cast<size_t>(-1);
+    
+    std::vector<int8_t> ctrl;
+    std::vector<value_type> slots;
+    size_t used;
+    size_t tombstones;
+    size_t group_mask;
+    Hash hasher;
+    
+    static uint32_t match_byte(const int8_t* group, int8_t value) {
+#if defined(__SSE2__)
+        __m128i ctrl_bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+        return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl_bytes, _mm_set1_epi8(value))));
+#else
+        uint32_t mask = 0;
+        for (size_t i = 0; i < GROUP_WIDTH; ++i) {
+            mask |= static_cast<uint32_t>(group[i] == value) << i;
+        }
+        return mask;
+#endif
+    }
+    
+    // Boş ya da silinmiş slotlar (işaret biti set)
+    static uint32_t match_free(const int8_t* group) {
+#if defined(__SSE2__)
+        return static_cast<uint32_t>(_mm_movemask_epi8(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(group))));
+#else
+        uint32_t mask = 0;
+        for (size_t i = 0; i < GROUP_WIDTH; ++i) {
+            mask |= static_cast<uint32_t>(group[i] < 0) << i;
+        }
+        return mask;
+#endif
+    }
+    
+    static int8_t fingerprint(size_t hash) { return static_cast<int8_t>(hash & 0x7F); }
+    
+    size_t find_index(const K& key, size_t hash) const {
+        if (slots.empty()) {
+            return NPOS;
+        }
+        
+        int8_t h2 = fingerprint(hash);
+        size_t group = (hash >> 7) & group_mask;
+        
+        for (size_t probe = 1; probe <= group_mask + 1; ++probe) {
+            const int8_t* ctrl_group = ctrl.data() + group * GROUP_WIDTH;
+            
+            for (uint32_t match = match_byte(ctrl_group, h2); match; match &= match - 1) {
+                size_t index = group * GROUP_WIDTH + __builtin_ctz(match);
+                if (slots[index].first == key) {
+                    return index;
+                }
+            }
+            
+            // Boş slot görülen grupta zincir biter
+            if (match_byte(ctrl_group, CTRL_EMPTY)) {
+                return NPOS;
+            }
+            group = (group + probe) & group_mask;
+        }
+        return NPOS;
+    }
+    
+    size_t free_index(size_t hash) const {
+        size_t group = (hash >> 7) & group_mask;
+        
+        for (size_t probe = 1;; ++probe) {
+            uint32_t match = match_free(ctrl.data() + group * GROUP_WIDTH);
+            if (match) {
+                return group * GROUP_WIDTH + __builtin_ctz(match);
+            }
+            group = (group + probe) & group_mask;
+        }
+    }
+    
+    void rehash(size_t new_capacity) {
+        std::vector<int8_t> old_ctrl = std::move(ctrl);
+        std::vector<value_type> old_slots = std::move(slots);
+        
+        ctrl.assign(new_capacity, CTRL_EMPTY);
+        slots.clear();
+        slots.resize(new_capacity);
+        group_mask = new_capacity / GROUP_WIDTH - 1;
+        tombstones = 0;
+        
+        for (size_t i = 0; i < old_ctrl.size(); ++i) {
+            if (old_ctrl[i] >= 0) {
+                size_t hash = hasher(old_slots[i].first);
+                size_t index = free_index(hash);
+                ctrl[index] = fingerprint(hash);
+                slots[index] = std::move(old_slots[i]);
+            }
+        }
+    }
+    
+    template <typename Map, typename Ref>
+    class basic_iterator {
+    private:
+        Map* map;
+        size_t index;
+        
+        void skip_free() {
+            while (index < map->ctrl.size() && map->ctrl[index] < 0) {
+                ++index;
+            }
+        }
+        
+    public:
+        basic_iterator(Map* m, size_t i) : map(m), index(i) { skip_free(); }
+        
+        Ref operator*() const { return map->slots[index]; }
+        auto operator->() const { return &map->slots[index]; }
+        basic_iterator& operator++() { ++index; skip_free(); return *this; }
+        bool operator==(const basic_iterator& other) const { return index == other.index; }
+        bool operator!=(const basic_iterator& other) const { return index != other.index; }
+    };
+    
+public:
+    using iterator = basic_iterator<FlatMap, value_type&>;
+    using const_iterator = basic_iterator<const FlatMap, const value_type&>;
+    
+    FlatMap() : used(0), tombstones(0), group_mask(0) {}
+    
+    iterator begin() { return iterator(this, 0); }
+    iterator end() { return iterator(this, ctrl.size()); }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, ctrl.size()); }
+    
+    iterator find(const K& key) {
+        size_t index = find_index(key, hasher(key));
+        return index == NPOS ? end() : iterator(this, index);
+    }
+    
+    const_iterator find(const K& key) const {
+        size_t index = find_index(key, hasher(key));
+        return index == NPOS ? end() : const_iterator(this, index);
+    }
+    
+    size_t count(const K& key) const { return find_index(key, hasher(key)) == NPOS ? 0 : 1; }
+    
+    const V& at(const K& key) const {
+        size_t index = find_index(key, hasher(key));
+        if (index == NPOS) {
+            throw std::out_of_range("FlatMap::at");
+        }
+        return slots[index].second;
+    }
+    
+    V& operator[](const K& key) {
+        size_t hash = hasher(key);
+        size_t index = find_index(key, hash);
+        if (index != NPOS) {
+            return slots[index].second;
+        }
+        
+        if ((used + tombstones + 1) * 8 > slots.size() * 7) {
+            // Çoğu tombstone ise aynı kapasitede temizle, değilse büyü
+            size_t capacity = std::max<size_t>(GROUP_WIDTH, slots.size());
+            rehash((used + 1) * 2 > capacity ? capacity * 2 : capacity);
+        }
+        
+        index = free_index(hash);
+        if (ctrl[index] == CTRL_DELETED) {
+            --tombstones;
+        }
+        ctrl[index] = fingerprint(hash);
+        slots[index] = value_type(key, V());
+        ++used;
+        return slots[index].second;
+    }
+    
+    bool erase(const K& key) {
+        size_t index = find_index(key, hasher(key));
+        if (index == NPOS) {
+            return false;
+        }
+        ctrl[index] = CTRL_DELETED;
+        slots[index] = value_type();
+        --used;
+        ++tombstones;
+        return true;
+    }
+    
+    void reserve(size_t n) {
+        size_t capacity = GROUP_WIDTH;
+        while (capacity * 7 < n * 8) {
+            capacity *= 2;
+        }
+        if (capacity > slots.size()) {
+            rehash(capacity);
+        }
+    }
+    
+    void clear() {
+        ctrl = std::vector<int8_t>();
+        slots = std::vector<value_type>();
+        used = 0;
+        tombstones = 0;
+        group_mask = 0;
+    }
+    
+    size_t size() const { return used; }
+    bool empty() const { return used == 0; }
+    size_t capacity() const { return slots.size(); }
+    size_t memory_bytes() const { return ctrl.capacity() + slots.capacity() * sizeof(value_type); }
 };
 
+// Shard bakiyeleri: adres -> bakiye
+using AccountMap = FlatMap<Address, uint64_t, AddressHash>;
+
 // ============================================================================
 // FRACTAL SHARDING SİSTEMİ
 // ============================================================================
 
+// Adres bitleriyle anahtarlanmış sıkıştırılmış sparse Merkle ağacı.
+// Tek yapraklı alt ağaç doğrudan yaprak hash'ini taşır, boş alt ağaç sıfırdır;
+// kök yalnızca hesaba (adres, bakiye) kümesine bağlıdır, ekleme sırasına değil.
+// update() sadece dokunulan yoldaki önbelleği düşürür, kök root() çağrısında
+// tembel olarak yeniden hesaplanır.
+class SparseMerkleTree {
+public:
+    SparseMerkleTree();
+    
+    void update(const Address& addr, uint64_t balance); // 0 = yaprağı sil
+    Hash256 root();
+    
+    size_t size() const { return leaves.size(); }
+    bool is_dirty() const { return dirty; }
+    
+private:
+    // [depth, prefix(20 byte)] -> iç düğüm hash'i
+    using NodeKey = std::array<uint8_t, 1 + 20>;
+    using LeafIterator = std::map<Address, uint64_t>::const_iterator;
+    
+    std::map<Address, uint64_t> leaves;
+    std::unordered_map<NodeKey, Hash256, ArrayHash> node_cache;
+    uint32_t max_cached_depth;
+    Hash256 cached_root;
+    bool dirty;
+    
+    static NodeKey node_key(uint32_t depth, const Address& prefix);
+    void invalidate_path(const Address& addr);
+    Hash256 compute(QuantumCrypto& crypto, uint32_t depth, const Address& prefix,
+                    LeafIterator begin, LeafIterator end);
+};
+
+// Vyukov tarzı sınırsız MPSC kuyruk: push lock-free (tek atomic exchange),
+// pop yalnızca tek tüketici thread'den çağrılmalıdır. Bir üretici push'un
+// ortasındayken pop geçici olarak false dönebilir; mesaj bir sonraki
+// drain'de görülür.
+template <typename T>
+class MpscQueue {
+private:
+    struct Node {
+        std::atomic<Node*> next;
+        T value;
+        
+        Node() : next(nullptr), value() {}
+        explicit Node(T v) : next(nullptr), value(std::move(v)) {}
+    };
+    
+    alignas(64) std::atomic<Node*> head;    // üreticiler
+    alignas(64) Node* tail;                 // tüketici
+    
+public:
+    MpscQueue() {
+        Node* stub = new Node();
+        head.store(stub, std::memory_order_relaxed);
+        tail = stub;
+    }
+    
+    ~MpscQueue() {
+        while (tail) {
+            Node* next = tail->next.load(std::memory_order_relaxed);
+            delete tail;
+            tail = next;
+        }
+    }
+    
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+    
+    void push(T value) {
+        Node* node = new Node(std::move(value));
+        Node* prev = head.exchange(node, std::memory_order_acq_rel);
+        prev->next.store(node, std::memory_order_release);
+    }
+    
+    bool pop(T& out) {
+        Node* next = tail->next.load(std::memory_order_acquire);
+        if (!next) {
+            return false;
+        }
+        out = std::move(next->value);
+        delete tail;
+        tail = next;
+        return true;
+    }
+};
+
+// Sınırlı tek üretici / tek tüketici halka kuyruk. Her taraf yalnızca kendi
+// indeksini yazar; karşı tarafın indeksini kendi önbelleği tükenince okur,
+// böylece sıcak yolda iki çekirdek aynı cache line'ı sürekli paylaşmaz.
+template <typename T>
+class SpscRing {
+private:
+    std::unique_ptr<T[]> slots;
+    size_t mask;
+    
+    alignas(64) std::atomic<size_t> head;   // tüketici
+    size_t cached_tail;
+    alignas(64) std::atomic<size_t> tail;   // üretici
+    size_t cached_head;
+    
+public:
+    // Kapasite ikinin kuvvetine yuvarlanır
+    explicit SpscRing(size_t capacity) : head(0), cached_tail(0), tail(0), cached_head(0) {
+        size_t rounded = 1;
+        while (rounded < capacity) {
+            rounded <<= 1;
+        }
+        slots.reset(new T[rounded]);
+        mask = rounded - 1;
+    }
+    
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+    
+    bool try_push(const T& value) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t - cached_head > mask) {
+            cached_head = head.load(std::memory_order_acquire);
+            if (t - cached_head > mask) {
+                return false;
+            }
+        }
+        slots[t & mask] = value;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+    
+    bool try_pop(T& out) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h == cached_tail) {
+            cached_tail = tail.load(std::memory_order_acquire);
+            if (h == cached_tail) {
+                return false;
+            }
+        }
+        out = std::move(slots[h & mask]);
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+    
+    bool empty() const {
+        return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+    }
+};
+
+// Cross-shard transfer: kaynak shard borçlandırıldı, kredi hedefte bekliyor
+struct CrossShardMessage {
+    uint32_t from_shard;
+    uint32_t to_shard;
+    uint64_t sequence;      // kaynak shard içinde artan; teslim sırasını belirler
+    uint64_t tag;           // çağıranın etiketi (ör. batch indeksi), ack'te döner
+    Hash256 tx_hash;
+    Address from;
+    Address to;
+    uint64_t amount;
+    uint64_t fee;
+};
+
+// Hedef shard'ın cevabı: accepted=false ise kaynak borcu geri alır
+struct CrossShardAck {
+    uint64_t sequence;
+    uint64_t tag;
+    bool accepted;
+};
+
+// Space-Saving (Metwally ve ark.) sketch: sabit K slotla en sık hesaplar.
+// Frekansı toplamın 1/K'sından büyük her hesap kesin olarak bulunur; tahmin
+// count - error <= gerçek <= count aralığındadır. Tarama önce 64-bit parmak
+// izlerinde yapılır, adres yalnızca eşleşmede karşılaştırılır.
+class HeavyHitterSketch {
+public:
+    struct Entry {
+        Address addr;
+        uint64_t count;
+        uint64_t error;         // slot devralındığında önceki sahibin sayısı
+    };
+    
+private:
+    std::array<uint64_t, HEAVY_HITTER_SLOTS> fingerprints;
+    std::array<Entry, HEAVY_HITTER_SLOTS> entries;
+    uint32_t used;
+    uint64_t total;
+    
+public:
+    HeavyHitterSketch() : fingerprints{}, entries{}, used(0), total(0) {}
+    
+    void add(const Address& addr, uint64_t weight = 1) {
+        uint64_t fp = AddressHash()(addr);
+        total += weight;
+        for (uint32_t i = 0; i < used; ++i) {
+            if (fingerprints[i] == fp && entries[i].addr == addr) {
+                entries[i].count += weight;
+                return;
+            }
+        }
+        if (used < HEAVY_HITTER_SLOTS) {
+            fingerprints[used] = fp;
+            entries[used++] = Entry{addr, weight, 0};
+            return;
+        }
+        
+        // En küçük sayacı devral: yeni hesap onun sayısını hata payı olarak taşır
+        uint32_t min_slot = 0;
+        for (uint32_t i = 1; i < HEAVY_HITTER_SLOTS; ++i) {
+            if (entries[i].count < entries[min_slot].count) {
+                min_slot = i;
+            }
+        }
+        uint64_t floor = entries[min_slot].count;
+        fingerprints[min_slot] = fp;
+        entries[min_slot] = Entry{addr, floor + weight, floor};
+    }
+    
+    // Sayıya göre azalan sırada
+    std::vector<Entry> top() const;
+    uint64_t total_weight() const { return total; }
+    
+    void clear() {
+        used = 0;
+        total = 0;
+    }
+};
+
+// Son uygulanan tx hash'leri: sabit kapasiteli halka ve halka konumlarını
+// tutan küçük bir açık adresli indeks (doğrusal yoklama, yük <= 1/2).
+// Halka dolunca en eski hash indeksten de silinir (geri kaydırmalı silme,
+// tombstone yok). contains/insert/erase O(1); bellek ilk eklemede ayrılır.
+class RecentTxIndex {
+private:
+    static constexpr uint16_t EMPTY = 0xFFFF;
+    
+    std::vector<Hash256> ring;
+    std::vector<uint8_t> live;          // erase edilen konumlar halkada kalır
+    std::vector<uint16_t> table;        // halka konumu ya da EMPTY
+    size_t capacity;
+    uint64_t inserted;
+    size_t live_count;
+    
+    size_t home(const Hash256& digest) const { return DigestHash()(digest) & (table.size() - 1); }
+    size_t find_slot(const Hash256& digest) const;
+    void remove_slot(size_t slot);
+    
+public:
+    explicit RecentTxIndex(size_t capacity = RECENT_TX_CAPACITY);
+    
+    bool contains(const Hash256& digest) const;
+    // false: hash zaten pencerede
+    bool insert(const Hash256& digest);
+    // İade edilen tx tekrar gönderilebilsin diye pencereden çıkarır
+    bool erase(const Hash256& digest);
+    
+    // Eskiden yeniye
+    std::vector<Hash256> recent() const;
+    size_t size() const { return live_count; }
+    void clear();
+};
+
+// Shard başına yük sayaçları: shard kilidi altında (ya da tek sahibi
+// tarafından) düz tamsayı olarak artırılır, telemetry() ile okunur.
+struct ShardCounters {
+    uint64_t applied;           // shard içi + kaynağı bu shard olan cross-shard
+    uint64_t failed;            // bakiye yetersiz ya da alıcı taşması
+    uint64_t duplicates;        // pencerede zaten olan tx (tekrar/replay)
+    uint64_t cross_out;         // borçlandırılıp gönderilen krediler
+    uint64_t cross_in;          // kabul edilen gelen krediler
+    uint64_t cross_rejected;    // hedefte taşan gelen krediler
+    uint64_t refunded;          // reddedilip kaynağa iade edilenler
+    uint64_t hot_credits;       // delta bloklarından bu shard'ın hesaplarına geçen krediler
+    uint64_t contended_locks;   // try_lock başarısız, beklendi
+    uint64_t lock_wait_ns;      // yalnızca çekişmeli kilitlerde ölçülür
+    uint64_t queue_depth_last;  // son teslimde gelen kuyruktan boşaltılan mesaj
+    uint64_t queue_depth_peak;
+    
+    ShardCounters()
+        : applied(0), failed(0), duplicates(0), cross_out(0), cross_in(0), cross_rejected(0),
+          refunded(0), hot_credits(0), contended_locks(0), lock_wait_ns(0),
+          queue_depth_last(0), queue_depth_peak(0) {}
+    
+    void note_queue_depth(uint64_t depth) {
+        queue_depth_last = depth;
+        queue_depth_peak = std::max(queue_depth_peak, depth);
+    }
+    
+    ShardCounters& operator+=(const ShardCounters& other);
+};
+
 struct ShardState {
     uint32_t shard_id;
     Hash256 state_root;
     uint64_t transaction_count;
-    std::unordered_map<Address, uint64_t> balances;
-    std::vector<Hash256> recent_transactions;
+    AccountMap balances;
+    RecentTxIndex recent_transactions;      // kaynağı bu shard olan uygulanmış tx'ler
+    SparseMerkleTree state_tree;
+    
+    // Ack bekleyen cross-shard borçlar (sequence -> mesaj)
+    uint64_t next_outbound_sequence;
+    std::unordered_map<uint64_t, CrossShardMessage> pending_debits;
+    
+    // Son yayınlanan görüntüden bu yana değişen bakiyeler (sırayla)
+    std::vector<std::pair<Address, uint64_t>> snapshot_changes;
+    
+    // Sıcak alıcı adayları: adres hash'ine göre doğrudan eşlenmiş slotlarda
+    // çoğunluk oylaması (Boyer-Moore). Batch boyunca bir slotun kredilerinin
+    // çoğunu alan adres slotta kalır; sayaç batch sınırında okunup sıfırlanır.
+    struct CreditCandidate {
+        Address addr;
+        uint32_t count;
+    };
+    std::array<CreditCandidate, HOT_CANDIDATE_SLOTS> credit_candidates;
+    
+    // Telemetri: sayaçlar ve hesap başına dokunuş (borç + kredi) sketch'i
+    ShardCounters counters;
+    HeavyHitterSketch touches;
     
     ShardState(uint32_t id);
+    
+    // Bakiye değişikliğini state ağacına ve bir sonraki görüntüye işler
+    void record_balance(const Address& addr, uint64_t balance) {
+        state_tree.update(addr, balance);
+        snapshot_changes.emplace_back(addr, balance);
+    }
+    
+    void note_credit(const Address& addr) {
+        auto& slot = credit_candidates[AddressHash()(addr) % HOT_CANDIDATE_SLOTS];
+        if (slot.count == 0) {
+            slot.addr = addr;
+            slot.count = 1;
+        } else if (slot.addr == addr) {
+            ++slot.count;
+        } else {
+            --slot.count;
+        }
+    }
+};
+
+// ============================================================================
+// MVCC STATE GÖRÜNTÜLERİ
+// ============================================================================
+
+// Bir shard'ın değişmez görüntüsü. Bakiyeler adres hash'ine göre kovalara
+// bölünmüş sıralı dizilerdir; yeni yükseklik yalnızca değişen kovaları
+// kopyalar, diğerlerini önceki görüntüyle paylaşır (copy-on-write).
+struct ShardSnapshot {
+    using Bucket = std::vector<std::pair<Address, uint64_t>>;
+    
+    uint32_t shard_id;
+    uint64_t height;            // bu shard'ın son değiştiği yükseklik
+    Hash256 state_root;
+    uint64_t transaction_count;
+    size_t account_count;
+    std::array<std::shared_ptr<const Bucket>, SNAPSHOT_BUCKETS> buckets;
+    
+    static uint32_t bucket_of(const Address& addr);
+    bool find(const Address& addr, uint64_t& balance) const;
+};
+
+// Bir batch yüksekliğindeki tüm state: okuyucular kilitsiz ve tutarlı okur,
+// yazıcılar hiç beklemez. Shard haritası da aynı yüksekliğe sabitlenir.
+struct StateSnapshot {
+    using RouteTable = std::array<uint8_t, (1u << SHARD_ROUTE_BITS)>;
+    
+    uint64_t height;
+    std::shared_ptr<const RouteTable> routes;
+    std::array<std::shared_ptr<const ShardSnapshot>, SHARD_COUNT> shards;
+    
+    uint32_t shard_of(const Address& addr) const;
+    uint64_t balance_of(const Address& addr) const;
+};
+
+// Bir rebalance turunun özeti
+struct ShardRebalanceResult {
+    uint32_t splits;
+    uint32_t merges;
+    size_t accounts_moved;
+    uint32_t active_shards;
+    
+    ShardRebalanceResult() : splits(0), merges(0), accounts_moved(0), active_shards(0) {}
+};
+
+// Bir shard'ın telemetri görüntüsü
+struct ShardTelemetry {
+    uint32_t shard_id;
+    bool active;
+    uint32_t depth;                     // prefix-trie bölgesi
+    uint32_t prefix;
+    size_t account_count;
+    size_t pending_debits;              // ack bekleyen cross-shard borçlar
+    uint64_t load;                      // son rebalance'tan bu yana
+    ShardCounters counters;
+    std::vector<HeavyHitterSketch::Entry> hot_accounts;
+    uint64_t touches;                   // sketch'e giren toplam dokunuş
 };
 
+// Tek çağrıda tüm shard'lar: her shard kendi kilidi altında tutarlı okunur
+struct TelemetrySnapshot {
+    std::vector<ShardTelemetry> shards; // yalnızca aktif shard'lar
+    ShardCounters totals;
+    uint64_t cross_shard_in_flight;
+    size_t hot_credit_accounts;         // delta tamponlu sıcak alıcılar
+    
+    TelemetrySnapshot() : cross_shard_in_flight(0), hot_credit_accounts(0) {}
+};
+
+class WriteAheadLog;
+
+// Hiyerarşik (prefix trie) shard haritası:
+//
+// Her adresin route hash'inin üst SHARD_ROUTE_BITS biti bir route_table
+// girdisi seçer. Aktif her slot, trie'de bir yaprağa, yani (depth, prefix)
+// bölgesine sahiptir ve bölgesindeki tüm girdiler o slotu gösterir. Sıcak bir
+// yaprak iki çocuğa bölünür (sağ yarı boş bir slota taşınır), soğuk kardeşler
+// tekrar birleşir. Taşıma yalnızca ilgili iki slotun kilidini tutar; diğer
+// shard'lar çalışmaya devam eder. Adres üzerinden kilit alan her yol kilitten
+// sonra sahipliği yeniden doğrular, eski rotayla gelen kredi mesajları yeni
+// sahibine iletilir.
+class ShardActorRuntime;
+
 class FractalSharding {
 private:
+    friend class ShardActorRuntime;     // sahip olduğu shard'lara kilitsiz erişir
+    
     std::array<std::unique_ptr<ShardState>, SHARD_COUNT> shards;
     std::array<std::mutex, SHARD_COUNT> shard_mutexes;
     
-    struct CrossShardMessage {
-        uint32_t from_shard;
-        uint32_t to_shard;
-        Hash256 tx_hash;
-        std::vector<uint8_t> data;
+    struct ShardRegion {
+        uint32_t depth;
+        uint32_t prefix;
+        bool active;
     };
     
-    std::queue<CrossShardMessage> cross_shard_queue;
-    std::mutex queue_mutex;
+    std::array<ShardRegion, SHARD_COUNT> regions;       // topology_mutex + slot kilitleri
+    std::array<std::atomic<uint8_t>, (1u << SHARD_ROUTE_BITS)> route_table;
+    std::array<std::atomic<uint64_t>, SHARD_COUNT> shard_load;
+    mutable std::mutex topology_mutex;
+    uint64_t topology_version;
     
-    uint32_t assign_shard(const Address& addr);
+    // Yayınlanan görüntüler: current_snapshot std::atomic_load/store ile okunur
+    std::shared_ptr<const StateSnapshot> current_snapshot;
+    std::vector<std::shared_ptr<const StateSnapshot>> snapshot_history;
+    uint64_t published_topology_version;
+    std::mutex publish_mutex;
+    mutable std::mutex history_mutex;
+    WriteAheadLog* journal;                 // publish_mutex; null = kalıcılık yok
+    
+    // Sıcak alıcılar: kredileri shard kilidi ve harita güncellemesi yerine
+    // kaynak shard'ın delta bloğuna eklenir (değişmeli toplama), batch
+    // sınırında flush_credit_deltas() ile hesap başına tek yazımda işlenir.
+    // Blok indeksi kaynak shard'dır: executor'da her blok tek worker'a aittir.
+    struct HotAccount {
+        Address addr;
+        uint64_t block_cap;     // bir bloğun bu hesap için biriktirebileceği en fazla kredi
+        uint64_t reserved;      // block_cap * SHARD_COUNT: kesin yolun taşma payı
+    };
+    // Blok b'ye yalnızca shard_mutexes[b] tutulurken ya da batch sınırında dokunulur
+    struct DeltaSlot {
+        uint64_t amount;        // henüz bakiyeye katılmamış kredi
+        uint64_t total;         // bu batch'te bloktan geçen toplam (block_cap sınırı)
+        uint32_t credits;
+    };
+    struct alignas(64) DeltaBlock {
+        std::array<DeltaSlot, HOT_ACCOUNT_LIMIT> slots;
+    };
+    
+    std::vector<HotAccount> hot_accounts;               // yalnızca batch sınırında değişir
+    FlatMap<Address, uint32_t, AddressHash> hot_index;  // adres -> hot_accounts indeksi
+    std::unique_ptr<DeltaBlock[]> credit_deltas;        // [kaynak shard]
+    uint32_t hot_threshold;
+    
+    // Hedef shard başına gelen krediler ve kaynak shard başına gelen ack'ler.
+    // Her kuyruğun tek tüketicisi, ilgili shard'ı o anda işleyen thread'dir.
+    std::array<MpscQueue<CrossShardMessage>, SHARD_COUNT> inbound;
+    std::array<MpscQueue<CrossShardAck>, SHARD_COUNT> acks;
+    std::array<std::mutex, SHARD_COUNT> inbound_consumer;
+    std::array<std::mutex, SHARD_COUNT> ack_consumer;
+    std::atomic<uint64_t> in_flight;
+    
+    uint32_t assign_shard(const Address& addr) const;
+    static uint32_t route_index(const Address& addr);
+    
+    // Adresin sahibi olan slotu kilitler; kilit alınırken sahiplik değiştiyse tekrar dener
+    std::unique_lock<std::mutex> lock_owner(const Address& addr, uint32_t& shard_id);
+    // Toplu erişim: adresleri sahip slota göre gruplar (grup içinde girdi
+    // sırası korunur), her slotu bir kez kilitleyip fn(shard, i) çağırır.
+    // Kilit alınırken taşınan adresler sonra lock_owner ile tek tek işlenir.
+    template <typename AddressOf, typename Fn>
+    void for_each_owned(size_t count, AddressOf address_of, Fn fn);
+    // Slot kilidi; yalnızca try_lock başarısızsa bekleme süresini ölçüp sayar
+    std::unique_lock<std::mutex> lock_shard(uint32_t shard_id);
+    
+    // Sıcak alıcıya kredi: bloğun payı yetmiyorsa false (çağıran kesin yolu kullanır)
+    bool credit_hot(uint32_t block, const Address& to, uint64_t amount);
+    // Hesap sıcaksa kesin yolun taşma payı, değilse 0
+    uint64_t hot_reserve(const Address& addr) const;
+    // Sahibinin kilidi tutulurken: bloğun bu hesaba biriktirdiği krediyi bakiyeye katar
+    bool absorb_delta(ShardState& shard, const Address& addr, uint32_t block);
+    
+    // Kilitsiz çekirdek: çağıran shard'ın kilidini tutar ya da onun tek sahibidir
+    bool apply_local(uint32_t shard_id, const Transaction& tx);
+    bool debit_sender(uint32_t shard_id, const Transaction& tx, const Hash256& tx_hash);
+    bool apply_credit(uint32_t shard_id, const Address& to, uint64_t amount);
+    void refund_sender(uint32_t shard_id, const Address& from, uint64_t amount, const Hash256& tx_hash);
+    
+    void assign_range(uint32_t depth, uint32_t prefix, uint32_t shard_id);
+    bool split_shard(uint32_t parent, uint32_t child, size_t& moved);
+    bool merge_shards(uint32_t keep, uint32_t drop, size_t& moved);
     
 public:
     FractalSharding();
     
-    bool route_transaction(const Transaction& tx);
-    bool process_cross_shard(const Transaction& tx);
+    bool route_transaction(const Transaction& tx, uint64_t tag = 0);
+    
+    // Faz 1: kaynakta borçlandır ve hedef kuyruğuna koy (kredi henüz uygulanmaz)
+    bool process_cross_shard(const Transaction& tx, uint64_t tag = 0);
+    
+    // Faz 2: hedef shard'ın kuyruğunu boşaltır, kredileri tek kilitle uygular,
+    // kaynak shard'lara ack gönderir. Teslim edilen mesaj sayısını döner.
+    size_t deliver_cross_shard(uint32_t to_shard);
+    
+    // Faz 3: kaynak shard'ın ack'lerini işler; reddedilenlerin borcu iade
+    // edilir ve etiketleri rolled_back'e eklenir. İade sayısını döner.
+    size_t process_acks(uint32_t from_shard, std::vector<uint64_t>* rolled_back = nullptr);
+    
+    // Tüm shard'lar için faz 2 + faz 3 (tek thread)
+    size_t pump_cross_shard();
+    uint64_t cross_shard_in_flight() const { return in_flight.load(std::memory_order_acquire); }
+    
     bool update_shard_state(uint32_t shard_id, const Transaction& tx);
+    
+    // Canlı shard durumu: yalnızca yürütme thread'i ya da sessiz anlarda
+    // okunmalı. Eşzamanlı okuyucular snapshot() kullanır.
     const ShardState* get_shard_state(uint32_t shard_id) const;
+    
+    uint32_t shard_of(const Address& addr) const { return assign_shard(addr); }
+    
+    // Gönderenin shard'ı bu tx'i son RECENT_TX_CAPACITY uygulamasında gördü mü?
+    // Yürütme yolları aynı hash'i tekrar (replay) olarak reddeder. Toplu
+    // sorgu: seen[i] = from[i]'nin shard'ı hashes[i]'yi gördüyse 1.
+    bool recently_applied(const Address& from, const Hash256& tx_hash);
+    void recently_applied(const std::vector<Address>& from, const std::vector<Hash256>& hashes,
+                          std::vector<uint8_t>& seen);
+    // Kilitli yolu kullanmayan yürütücüler (STM) batch sonucunu böyle işler:
+    // uygulananlar gönderenin penceresine batch sırasıyla girer; sayaçlar ve
+    // sketch kilitli yoldaki gibi güncellenir (applied/failed/duplicates/
+    // cross_out kaynakta, cross_in hedefte). replay[i]: tekrar olarak elendi.
+    void record_applied(const std::vector<Transaction>& batch, const std::vector<Hash256>& hashes,
+                        const std::vector<uint8_t>& applied, const std::vector<uint8_t>& replay);
+    
+    void mint(const Address& addr, uint64_t amount); // genesis / bridge girişi
+    
+    // Hesap okuma/yazma (batch dışı yürütücüler için); yoksa 0. Toplu
+    // sürümler her shard'ı bir kez kilitler.
+    uint64_t balance_of(const Address& addr);
+    void balances_of(const std::vector<Address>& addrs, std::vector<uint64_t>& out);
+    void commit_balances(const std::vector<std::pair<Address, uint64_t>>& balances);
+    
+    // Kurtarma: bakiyeleri olduğu gibi yazar (0 = hesabı sil), yükü saymaz
+    void restore_balances(const std::vector<std::pair<Address, uint64_t>>& balances);
+    
+    // Batch sınırında (eşzamanlı yazıcı yokken): sıcak alıcıların delta
+    // bloklarını bakiyelere katar ve aday sayaçlarından sıcak kümeyi yeniler
+    void flush_credit_deltas();
+    // 0 = delta tamponu kapalı (tüm krediler kesin yoldan)
+    void set_hot_credit_threshold(uint32_t credits_per_batch);
+    size_t hot_account_count() const { return hot_accounts.size(); }
+    
+    // Batch sonunda kirli shard'ların state_root'unu bir kez hesaplar
+    void commit_state_roots();
+    
+    // Shard başına sayaçlar, kuyruk derinliği, kilit beklemesi ve en sık
+    // hesaplar. reset = true: okunduktan sonra sayaçlar ve sketch'ler sıfırlanır
+    // (aralık telemetrisi); load rebalance'a ait olduğu için sıfırlanmaz.
+    TelemetrySnapshot telemetry(bool reset = false);
+    
+    // Son çağrıdan bu yana biriken yüke göre böl/birleştir. Referans, aktif
+    // shard yüklerinin medyanıdır (tek sıcak adres ortalamayı şişirmesin):
+    // load > split_factor * medyan ise böl, kardeş toplamı
+    // < merge_factor * medyan ise birleştir.
+    ShardRebalanceResult rebalance(double split_factor = 4.0, double merge_factor = 0.25);
+    uint32_t active_shard_count() const;
+    bool shard_region(uint32_t shard_id, uint32_t& depth, uint32_t& prefix) const;
+    
+    // Batch sınırında çağrılır: state root'ları kesinleştirir ve değişen
+    // kovaları kopyalayarak height yüksekliğinde yeni bir görüntü yayınlar.
+    //
+    // Ön koşul: execute() / flush_credit_deltas() ile eşzamanlı değil, yani
+    // batch'in tüm cross-shard mesajları ve sıcak kredileri yerleşmiş olmalı.
+    // Kesit tüm shard kilitleri tutularak alınır; yine de yolda mesaj ya da
+    // işlenmemiş sıcak kredi görülürse (borç var, kredi yok) görüntü
+    // yayınlanmaz ve false döner. Değişiklikler bir sonraki çağrıya kalır.
+    bool publish_snapshots(uint64_t height);
+    
+    // Son yayınlanan görüntü (asla null); kilitsiz
+    std::shared_ptr<const StateSnapshot> snapshot() const;
+    // Son SNAPSHOT_HISTORY yükseklikten biri; yoksa null
+    std::shared_ptr<const StateSnapshot> snapshot_at(uint64_t height) const;
+    
+    // Bağlıysa her publish_snapshots yüksekliğin değişikliklerini görüntü
+    // yayınlanmadan önce log'a yazar ve gerektiğinde checkpoint alır
+    void attach_journal(WriteAheadLog* wal);
+};
+
+// ============================================================================
+// KALICI STATE: WRITE-AHEAD LOG
+// ============================================================================
+
+struct DurabilityConfig {
+    std::string directory;
+    uint32_t fsync_every_batches;       // grup commit: N batch'te bir fdatasync
+    uint32_t checkpoint_every_batches;  // 0 = otomatik checkpoint yok
+    
+    DurabilityConfig() : fsync_every_batches(1), checkpoint_every_batches(64) {}
+};
+
+struct WalRecoveryResult {
+    uint64_t checkpoint_height;     // yüklenen checkpoint (yoksa 0)
+    uint64_t recovered_height;      // replay sonrası son yükseklik
+    size_t records_replayed;
+    size_t accounts_restored;
+    bool torn_tail;                 // yarım kalan kayıt bulunup kesildi
+    
+    WalRecoveryResult()
+        : checkpoint_height(0), recovered_height(0), records_replayed(0),
+          accounts_restored(0), torn_tail(false) {}
+};
+
+// Batch başına tek kayıt: [magic | uzunluk | yükseklik | n | n x (adres, bakiye) | crc32c].
+// Kayıt, o yükseklikte değişen her hesabın son bakiyesini taşır (0 = silindi),
+// böylece replay sırası shard'lar arası taşımalardan bağımsızdır. Bir batch'in
+// tüm tx'leri tek write() ile yazılır; fdatasync en fazla batch başına bir kez,
+// fsync_every_batches > 1 ise daha seyrek yapılır (son N batch'lik pencere
+// çökmede kaybolabilir, ama state tutarlı bir yüksekliğe döner).
+//
+// Checkpoint, yayınlanmış değişmez StateSnapshot'tan kilitsiz yazılır: shard
+// başına kendi CRC'si olan bir bölüm. Dosya önce .tmp olarak yazılıp fsync
+// edilir ve rename ile yerine konur; ardından yeni bir log segmenti açılır ve
+// eski segmentler silinir. Kurtarma son geçerli checkpoint'i yükler, sonraki
+// segmentleri replay eder ve yarım kalan kuyruğu keser.
+class WriteAheadLog {
+private:
+    DurabilityConfig config;
+    int log_fd;
+    uint64_t segment_base;          // açık segmentin başladığı checkpoint yüksekliği
+    uint64_t last_height;           // log'a yazılan son yükseklik
+    uint64_t last_checkpoint;
+    uint32_t unsynced_batches;
+    std::vector<uint8_t> buffer;
+    
+    std::atomic<uint64_t> fsyncs;
+    std::atomic<uint64_t> bytes;
+    
+    std::string path_of(const char* prefix, uint64_t height, const char* suffix) const;
+    void open_segment(uint64_t base);
+    void write_all(int fd, const uint8_t* data, size_t len);
+    void sync_directory();
+    
+public:
+    // Dizin yoksa oluşturulur; I/O hatalarında std::runtime_error atar
+    explicit WriteAheadLog(const DurabilityConfig& config);
+    ~WriteAheadLog();
+    
+    WriteAheadLog(const WriteAheadLog&) = delete;
+    WriteAheadLog& operator=(const WriteAheadLog&) = delete;
+    
+    // Son checkpoint + log'dan state'i kurar; boş bir FractalSharding'e
+    // uygulanmalıdır. Sonraki append'ler kurtarılan yükseklikten devam eder.
+    WalRecoveryResult recover(FractalSharding& sharding);
+    
+    // Yüksekliğin değişiklikleri (adres başına son bakiye); height <= son
+    // yazılan yükseklik ise yok sayılır
+    void append(uint64_t height, const std::vector<std::pair<Address, uint64_t>>& changes);
+    void sync();
+    
+    bool checkpoint_due(uint64_t height) const;
+    void checkpoint(const StateSnapshot& snapshot);
+    
+    uint64_t logged_height() const { return last_height; }
+    uint64_t fsync_count() const { return fsyncs.load(std::memory_order_relaxed); }
+    uint64_t bytes_written() const { return bytes.load(std::memory_order_relaxed); }
+};
+
+// ============================================================================
+// PARALEL BATCH YÜRÜTME
+// ============================================================================
+
+// Bir batch'in yürütme sonucu; applied[i] girdi sırasındaki i. tx içindir.
+struct BatchExecutionResult {
+    std::vector<uint8_t> applied;
+    size_t applied_count;
+    size_t rejected_count;
+    size_t cross_shard_count;
+    size_t rolled_back_count;   // hedefte reddedilip kaynağa iade edilenler
+    size_t unsettled_count;     // tur sınırında hâlâ yolda olan mesajlar (normalde 0)
+    
+    BatchExecutionResult()
+        : applied_count(0), rejected_count(0), cross_shard_count(0), rolled_back_count(0),
+          unsettled_count(0) {}
+};
+
+// Batch'i kaynak shard'a göre böler ve üç paralel fazda yürütür:
+//
+// Faz 1: Her kaynak shard'ın tx'leri batch sırasıyla tek worker'da işlenir.
+//        Shard içi tx'ler hemen uygulanır; cross-shard tx'lerde yalnızca
+//        borç düşülür ve kredi hedef shard'ın kuyruğuna girer.
+// Faz 2: Her hedef shard kuyruğunu boşaltır ve kredileri toplu uygular.
+// Faz 3: Her kaynak shard ack'lerini işler (kesinleştir / iade et).
+//        Faz 2-3, bölge taşımasıyla iletilen mesajlar dahil yolda mesaj
+//        kalmayana kadar tekrarlanır (MAX_SETTLE_ROUNDS ile sınırlı).
+//
+// Bir hesabın tüm tx'leri aynı kaynak bucket'ında olduğundan nonce sırası
+// korunur. Cross-shard krediler faz 2'de geldiği için aynı batch'te
+// harcanamaz. Sonuç worker sayısından bağımsızdır (deterministik).
+//
+// Sıcak alıcılara (önceki batch'lerde eşiği geçen) krediler kaynak shard'ın
+// delta bloğunda toplanır ve batch sonunda tek yazımla işlenir. Sıcak hesabın
+// borcu kesin kontrol edilir: bakiye yetmezse aynı shard'ın biriktirdiği
+// krediler katılıp tekrar bakılır, yani sonuç delta olmadan aynıdır.
+class BatchExecutor {
+private:
+    // Teslim/ack turu üst sınırı; her tur bir taşıma yönlendirmesini çözer
+    static constexpr size_t MAX_SETTLE_ROUNDS = 64;
+    
+    // execute_optimistic seri yola düşer: tek worker, STM_MIN_PARALLEL_BATCH'ten
+    // küçük batch ya da tx'lerin 1/STM_MAX_CONFLICT_DENOMINATOR'ından fazlası son
+    // STM_CONFLICT_WINDOW tx içinde yazılmış bir hesaba dokunuyorsa
+    static constexpr size_t STM_MIN_PARALLEL_BATCH = 256;
+    static constexpr uint32_t STM_CONFLICT_WINDOW = 64;
+    static constexpr size_t STM_MAX_CONFLICT_DENOMINATOR = 4;
+    
+    FractalSharding& sharding;
+    
+    std::vector<std::thread> workers;
+    std::mutex pool_mutex;
+    std::condition_variable work_cv;
+    std::condition_variable done_cv;
+    uint64_t job_generation;
+    size_t busy_workers;
+    bool stopping;
+    
+    // Aktif iş (pool_mutex ile yayınlanır)
+    const std::function<void(size_t)>* job_fn;
+    size_t job_count;
+    std::atomic<size_t> next_item;
+    
+    void worker_loop();
+    void drain_items();
+    void run_parallel(size_t count, const std::function<void(size_t)>& fn);
+    
+public:
+    // worker_count = 0: donanım thread sayısı (çağıran thread dahil)
+    explicit BatchExecutor(FractalSharding& sharding, size_t worker_count = 0);
+    ~BatchExecutor();
+    
+    BatchExecutor(const BatchExecutor&) = delete;
+    BatchExecutor& operator=(const BatchExecutor&) = delete;
+    
+    BatchExecutionResult execute(const std::vector<Transaction>& batch);
+    
+    // Block-STM tarzı iyimser yürütme: tx'ler çok sürümlü hesap belleği
+    // üzerinde spekülatif ve paralel çalışır, okuma kümeleri doğrulanır,
+    // çakışanlar batch sırasıyla yeniden yürütülür. Sonuç, batch'in sırayla
+    // (kredi hemen harcanabilir) uygulanmasıyla birebir aynıdır; shard
+    // kilitleri yalnızca başlangıç okumasında ve sonuç yazımında alınır.
+    // Yürütme süresince batch'in hesaplarına başka yazıcı olmamalıdır.
+    // Tekrar penceresindeki ve batch'te daha önce geçen tx'ler yürütülmez.
+    // Spekülasyonun kazanç getiremeyeceği batch'ler (tek worker, küçük ya da
+    // çakışması yüksek) aynı kurallarla sırayla yürütülür.
+    BatchExecutionResult execute_optimistic(const std::vector<Transaction>& batch);
+    
+    size_t worker_count() const { return workers.size() + 1; }
+};
+
+// ============================================================================
+// SHARD-PER-CORE AKTÖR YÜRÜTME
+// ============================================================================
+
+// BatchExecutor'ın kilitsiz karşılığı. Her worker bir çekirdeğe sabitlenir
+// ve aktif shard'ların bir alt kümesinin tek sahibidir; tx'ler sahibine
+// SPSC kuyrukla ulaşır ve yürütme yolunda shard kilidi alınmaz. Cross-shard
+// krediler worker çiftleri arasındaki SPSC halkalarla hedefin sahibine gider,
+// reddedilen krediler aynı yoldan kaynağa iade edilir. Faz ve teslim sırası
+// BatchExecutor ile aynı olduğundan sonuç da birebir aynıdır.
+//
+// Bellek: bir shard yeni bir sahibe geçtiğinde hesap tablosu o worker'ın
+// thread'inde yeniden kurulur. Linux'un first-touch politikasıyla sayfalar
+// sahibin NUMA düğümünde ayrılır (libnuma gerekmez).
+//
+// execute() sürerken FractalSharding'e başka yazıcı olmamalıdır (rebalance
+// dahil); okuyucular snapshot() kullanır.
+class ShardActorRuntime {
+private:
+    struct Worker;
+    
+    FractalSharding& sharding;
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::array<uint32_t, SHARD_COUNT> owner;    // batch boyunca sabit
+    std::array<int32_t, SHARD_COUNT> home;      // tablonun kurulduğu worker (-1: henüz yok)
+    size_t pinned;
+    
+    // Aktif batch (execute süresince salt okunur)
+    const std::vector<Transaction>* batch;
+    BatchExecutionResult* result;
+    
+    std::mutex done_mutex;
+    std::condition_variable done_cv;
+    size_t finished;
+    
+    void worker_loop(size_t index);
+    void run_shard(size_t index, uint32_t shard_id, const std::vector<uint32_t>& indices);
+    void finish_batch(size_t index);
+    
+public:
+    // worker_count = 0: donanım thread sayısı
+    explicit ShardActorRuntime(FractalSharding& sharding, size_t worker_count = 0, bool pin_threads = true);
+    ~ShardActorRuntime();
+    
+    ShardActorRuntime(const ShardActorRuntime&) = delete;
+    ShardActorRuntime& operator=(const ShardActorRuntime&) = delete;
+    
+    BatchExecutionResult execute(const std::vector<Transaction>& batch);
+    
+    size_t worker_count() const { return workers.size(); }
+    size_t pinned_count() const { return pinned; }
+    uint32_t owner_of(uint32_t shard_id) const { return owner[shard_id]; }
 };
 
 // ============================================================================
 // AI-OPTIMIZED ROUTING MOTORU
 // ============================================================================
 
+// Yönlü kenar anahtarı (from << 32 | to) için: iki uç da karışır
+struct EdgeKeyHash {
+    size_t operator()(uint64_t key) const noexcept {
+        key *= 0x9E3779B97F4A7C15ULL;
+        return static_cast<size_t>(key ^ (key >> 32));
+    }
+};
+
+// Ağ topolojisi açık bir komşuluk grafiğidir: düğümler ilk görüldüklerinde
+// yoğun bir indeks alır, yol hesabı yalnızca indeks dizileriyle çalışır.
+// Kenar maliyeti = bağlantı gecikmesi + hedef düğümün metrik maliyeti,
+// öğrenilmiş Q değeriyle indirilir (negatife düşmez).
+//
+// Eşzamanlılık (RCU): yazıcılar (update_metrics, learn, add_link) tek bir
+// kilit altında bir taslak durumu değiştirir; publish() taslağı değişmez bir
+// RouterState olarak atomik yayınlar. Durum parçalıdır: düğüm metrikleri ve
+// topoloji 256 düğümlük, Q tablosu 64 kenar parçasındadır; yayın yalnızca
+// değişen parçaları kopyalar, gerisi önceki görüntüyle paylaşılır. Okuyucular
+// görüntüyü std::atomic_load ile alır ve rotayı kilitsiz hesaplar. Taslak
+// kirliyse okuyucu yazıcı kilidini try_lock ile almayı dener ve başarırsa
+// yayınlar; alamazsa beklemez, mevcut görüntüyle devam eder. Tek thread'de
+// her sorgu böylece son yazımı görür.
+//
+// İsteğe bağlı ön işleme (prepare_hierarchy): özelleştirilebilir contraction
+// hierarchy. Düğüm sırası yalnızca topolojiden (nested dissection) çıkar,
+// dolgu kenarları metrikten bağımsızdır; kenar ağırlıkları "özelleştirme"
+// adımında alttan üste üçgenlerle hesaplanır. Metrik/Q değişiklikleri
+// yayında yalnızca etkilenen yayları yeniden özelleştirir. Sorgu, iki uçtan
+// eliminasyon ağacında köke yürüyen yukarı taramadır (heap yok).
 class AIRouter {
 public:
     struct NetworkMetrics {
@@ -234,29 +1617,422 @@ public:
         double bandwidth;
         double node_reputation;
     };
+    
+    struct Link {
+        uint32_t to;
+        double latency;
+    };
+    
+    // Çok yollu gönderimde bir yolun gözlenen sonucu
+    struct PathFeedback {
+        std::vector<PublicKey> path;
+        double reward;
+    };
+    
+    struct RouteCacheStats {
+        uint64_t hits;
+        uint64_t misses;            // önbellekte yoktu
+        uint64_t recomputes;        // vardı ama bir düğüm/kenarı eşiği aştı ya da eskidi
+        uint64_t invalidations;     // eşiği aşan maliyet ya da Q değişikliği
+        size_t entries;
+        
+        RouteCacheStats() : hits(0), misses(0), recomputes(0), invalidations(0), entries(0) {}
+        double hit_rate() const {
+            uint64_t total = hits + misses + recomputes;
+            return total == 0 ? 0.0 : static_cast<double>(hits) / total;
+        }
+    };
+    
+    static constexpr uint32_t CHUNK_BITS = 8;
+    static constexpr uint32_t CHUNK_NODES = 1u << CHUNK_BITS;
+    static constexpr uint32_t EDGE_SHARDS = 64;
+    static constexpr uint32_t CACHE_SHARDS = 16;
+    static constexpr uint32_t ARC_BLOCK_BITS = 12;
+    static constexpr uint32_t ARC_BLOCK = 1u << ARC_BLOCK_BITS;
+    
+    struct HierarchyStats {
+        bool active;
+        size_t nodes;
+        size_t links;
+        size_t arcs;                // orijinal + dolgu (yönsüz)
+        uint32_t tree_depth;        // eliminasyon ağacının en uzun yolu
+        double order_ms;
+        double customize_ms;
+        uint64_t recustomizations;  // kısmi özelleştirme sayısı (yayın başına bir)
+        uint64_t recustomized_arcs;   // yeniden hesaplanan ya da üçgenle düşürülen yaylar
+        uint64_t full_fallbacks;    // kısmi iş tam özelleştirmeyi aştı
+        
+        HierarchyStats() : active(false), nodes(0), links(0), arcs(0), tree_depth(0),
+                           order_ms(0.0), customize_ms(0.0), recustomizations(0), recustomized_arcs(0),
+                           full_fallbacks(0) {}
+    };
 
 private:
-    std::unordered_map<PublicKey, NetworkMetrics> node_metrics;
-    std::unordered_map<std::string, double> q_table;
+    struct ChangeStamp {
+        uint64_t epoch;
+        double baseline;            // son damgadaki değer; sapma buna göre ölçülür
+    };
+    
+    // Sütun düzeni (SoA): maliyet çekirdeği her faktörü ardışık okur, en kısa
+    // yol döngüsü yalnızca cost dizisine dokunur
+    struct MetricChunk {
+        std::array<double, CHUNK_NODES> latency;
+        std::array<double, CHUNK_NODES> loss;
+        std::array<double, CHUNK_NODES> bandwidth;
+        std::array<double, CHUNK_NODES> reputation;
+        std::array<double, CHUNK_NODES> cost;           // metrik yoksa 1.0
+        std::array<ChangeStamp, CHUNK_NODES> stamps;
+        std::array<uint64_t, CHUNK_NODES / 64> stale;   // sütunu değişti, maliyeti yayında hesaplanacak
+    };
+    
+    struct TopologyChunk {
+        std::array<PublicKey, CHUNK_NODES> keys;
+        std::array<std::vector<Link>, CHUNK_NODES> adjacency;
+    };
+    
+    // Kenar durumu: öğrenilmiş Q ve rota önbelleği için değişiklik damgası
+    struct EdgeState {
+        double q;
+        bool learned;
+        ChangeStamp stamp;
+    };
+    using EdgeShard = FlatMap<uint64_t, EdgeState, EdgeKeyHash>;
+    using NodeIndex = FlatMap<PublicKey, uint32_t, DigestHash>;
+    
+    // Hiyerarşi topolojisi (metrikten bağımsız, değişmez). Tüm indeksler sıra
+    // (rank) uzayındadır; yay, alt uçtaki düğümün up listesinde tutulur.
+    struct HierarchyTopology {
+        std::vector<uint32_t> rank;         // düğüm -> sıra
+        std::vector<uint32_t> order;        // sıra -> düğüm
+        std::vector<uint32_t> up_begin;     // CSR, sıra başına üst komşular (artan)
+        std::vector<uint32_t> up_head;
+        std::vector<uint32_t> down_begin;   // CSR, sıra başına alt komşular (artan)
+        std::vector<uint32_t> down_tail;
+        std::vector<uint32_t> down_arc;     // alt komşuya giden yayın kimliği
+        uint32_t depth;
+        uint64_t triangles;                 // tam özelleştirmenin işi
+        
+        uint32_t nodes() const { return static_cast<uint32_t>(order.size()); }
+        uint32_t arcs() const { return static_cast<uint32_t>(up_head.size()); }
+        uint32_t parent(uint32_t r) const {
+            return up_begin[r] == up_begin[r + 1] ? UINT32_MAX : up_head[up_begin[r]];
+        }
+        // Yoksa UINT32_MAX
+        uint32_t find_arc(uint32_t low, uint32_t high) const;
+    };
+    
+    // Özelleştirilmiş ağırlıklar: up = alt -> üst, down = üst -> alt; via,
+    // kısayolun ortadaki (daha alt) düğümü (UINT32_MAX: doğrudan bağlantı)
+    struct ArcBlock {
+        std::array<double, ARC_BLOCK> up;
+        std::array<double, ARC_BLOCK> down;
+        std::array<uint32_t, ARC_BLOCK> up_via;
+        std::array<uint32_t, ARC_BLOCK> down_via;
+    };
+    
+    struct Hierarchy {
+        std::shared_ptr<const HierarchyTopology> topology;
+        std::vector<std::shared_ptr<const ArcBlock>> blocks;
+        
+        double up(uint32_t arc) const { return blocks[arc >> ARC_BLOCK_BITS]->up[arc & (ARC_BLOCK - 1)]; }
+        double down(uint32_t arc) const { return blocks[arc >> ARC_BLOCK_BITS]->down[arc & (ARC_BLOCK - 1)]; }
+        uint32_t up_via(uint32_t arc) const { return blocks[arc >> ARC_BLOCK_BITS]->up_via[arc & (ARC_BLOCK - 1)]; }
+        uint32_t down_via(uint32_t arc) const { return blocks[arc >> ARC_BLOCK_BITS]->down_via[arc & (ARC_BLOCK - 1)]; }
+    };
+    
+    // Yayınlanmış görüntü: değişmez, okuyucular arasında paylaşılır
+    struct RouterState {
+        std::shared_ptr<const NodeIndex> index;
+        std::vector<std::shared_ptr<const MetricChunk>> metrics;
+        std::vector<std::shared_ptr<const TopologyChunk>> topology;
+        std::array<std::shared_ptr<const EdgeShard>, EDGE_SHARDS> edges;
+        size_t node_count;
+        size_t links;
+        size_t q_entries;
+        uint64_t epoch;             // eşiği aşan her değişiklikte artar
+        uint64_t topology_epoch;    // son yeni bağlantının epoch'u
+        uint64_t max_staleness;
+        size_t cache_capacity;      // 0 = önbellek kapalı
+        std::shared_ptr<const Hierarchy> hierarchy;     // yoksa Dijkstra
+        
+        const MetricChunk& metric_chunk(uint32_t node) const { return *metrics[node >> CHUNK_BITS]; }
+        const TopologyChunk& topology_chunk(uint32_t node) const { return *topology[node >> CHUNK_BITS]; }
+        const PublicKey& key(uint32_t node) const { return topology_chunk(node).keys[node & (CHUNK_NODES - 1)]; }
+        bool lookup(const PublicKey& node, uint32_t& index) const;
+        const EdgeState* edge(uint64_t key) const;
+    };
+    
+    // Rota önbelleği: (kaynak, hedef) -> yol ve hesaplandığı epoch. Kayıt,
+    // yolundaki bir düğüm ya da kenar kendisinden sonra damgalandıysa
+    // geçersizdir (tembel, yalnızca etkilenen kayıtlar). Yol dışındaki
+    // ucuzlamalar max_staleness epoch sonra yeniden hesaplamayla yakalanır;
+    // bağlantı eklemek tüm kayıtları eskitir. Parçalı kilitler yalnızca
+    // arama/ekleme için tutulur, yol hesabı kilit dışındadır.
+    struct CachedRoute {
+        std::vector<uint32_t> hops;
+        uint64_t epoch;
+    };
+    struct alignas(64) CacheShard {
+        std::mutex mutex;
+        FlatMap<uint64_t, CachedRoute, EdgeKeyHash> routes;
+    };
+    
+    std::shared_ptr<const RouterState> current;     // std::atomic_load/store
     
+    // Yazıcı tarafı: write_mutex altında
+    std::mutex write_mutex;
+    std::shared_ptr<RouterState> draft;
+    std::vector<uint8_t> metric_owned;              // taslak parçayı zaten kopyaladı mı
+    std::vector<uint8_t> topology_owned;
+    std::array<uint8_t, EDGE_SHARDS> edge_owned;
+    bool index_owned;
+    std::vector<uint32_t> stale_chunks;             // maliyeti bekleyen metrik parçaları
+    std::atomic<bool> dirty;
+    double change_threshold;
     double learning_rate;
     double discount_factor;
     
-    std::vector<PublicKey> calculate_optimal_path(
+    // Hiyerarşi varken girdi ağırlığı değişen düğümler (gelen kenarlar) ve kenarlar
+    std::vector<uint32_t> hierarchy_nodes;
+    std::vector<uint64_t> hierarchy_edges;
+    std::vector<uint8_t> arc_flags;                 // recustomize bayrakları, çağrılar arasında sıfır
+    HierarchyStats hierarchy_info;
+    
+    std::array<CacheShard, CACHE_SHARDS> cache;
+    std::atomic<uint64_t> cache_hits;
+    std::atomic<uint64_t> cache_misses;
+    std::atomic<uint64_t> cache_recomputes;
+    std::atomic<uint64_t> cache_invalidations;
+    
+    static uint64_t edge_key(uint32_t from, uint32_t to) {
+        return static_cast<uint64_t>(from) << 32 | to;
+    }
+    static uint32_t edge_shard(uint64_t key) {
+        return static_cast<uint32_t>(EdgeKeyHash()(key) >> 58);
+    }
+    
+    // Yazıcı yardımcıları (write_mutex tutulurken)
+    uint32_t intern(const PublicKey& node);
+    MetricChunk& writable_metrics(uint32_t node);
+    TopologyChunk& writable_topology(uint32_t node);
+    EdgeState& writable_edge(uint64_t key);
+    bool stamp_change(ChangeStamp& stamp, double value);
+    void set_metrics(uint32_t node, const NetworkMetrics& metrics);
+    // Bekleyen parçaların maliyetini çekirdekle hesaplar, değişenleri damgalar
+    void refresh_costs();
+    void publish_locked();
+    void note_hierarchy_edge(uint32_t from, uint32_t to);
+    void learn_path(const std::vector<PublicKey>& path, double reward);
+    
+    // Hiyerarşi: sıra + dolgu, tam ve kısmi özelleştirme, sorgu
+    static std::shared_ptr<HierarchyTopology> build_hierarchy_topology(const RouterState& state, size_t max_arcs);
+    static double input_weight(const RouterState& state, const HierarchyTopology& topology, uint32_t low, uint32_t high, bool upward);
+    static void customize(const RouterState& state, Hierarchy& hierarchy);
+    size_t recustomize(const RouterState& state, Hierarchy& hierarchy);
+    static bool hierarchy_route(const RouterState& state, uint32_t source, uint32_t dest, std::vector<uint32_t>& hops);
+    
+    // Okuyucu: gerekirse yayınlar, son görüntüyü döner
+    std::shared_ptr<const RouterState> view();
+    
+    static double step_cost(const RouterState& state, uint32_t from, uint32_t to);
+    
+    using EdgeSet = FlatMap<uint64_t, uint8_t, EdgeKeyHash>;
+    
+    // İkili heap'li tek kaynaklı Dijkstra; targets'taki düğümlerin hepsi
+    // kesinleşince durur. allowed boş değilse yalnızca işaretli düğümler,
+    // blocked verilirse içindeki yönlü kenarlar kullanılmaz.
+    static void shortest_tree(const RouterState& state, uint32_t source, const std::vector<uint32_t>& targets,
+                              const std::vector<uint8_t>& allowed,
+                              std::vector<double>& distance, std::vector<uint32_t>& previous,
+                              const EdgeSet* blocked = nullptr);
+    // Yönlü kenar ağırlığı (gecikme + adım maliyeti); bağlantı yoksa sonsuz
+    static double edge_weight(const RouterState& state, uint32_t from, uint32_t to);
+    static bool extract_path(const std::vector<double>& distance, const std::vector<uint32_t>& previous,
+                             uint32_t dest, std::vector<uint32_t>& hops);
+    static bool shortest_path(const RouterState& state, uint32_t source, uint32_t dest,
+                              const std::vector<uint8_t>& allowed, std::vector<uint32_t>& hops);
+    // Tüm graf üzerinde: hiyerarşi varsa ve düğümleri kapsıyorsa o, yoksa Dijkstra
+    static bool route_hops(const RouterState& state, uint32_t source, uint32_t dest, std::vector<uint32_t>& hops);
+    static std::vector<PublicKey> to_keys(const RouterState& state, const std::vector<uint32_t>& hops);
+    static bool route_fresh(const RouterState& state, const CachedRoute& route);
+    std::vector<PublicKey> cached_route(const RouterState& state, const PublicKey& source, const PublicKey& dest);
+    
+    // Bağlantı tanımlanmamışsa eski davranış: available_nodes tam graf kabul
+    // edilir. Tam grafta dizi taramalı Dijkstra O(V^2) ile en iyisidir.
+    // Aynı kaynaktan birden çok hedef tek taramada çözülür.
+    static std::vector<std::vector<PublicKey>> calculate_optimal_paths(
+        const RouterState& state,
+        const PublicKey& source,
+        const std::vector<PublicKey>& dests,
+        const std::vector<PublicKey>& available_nodes
+    );
+    static std::vector<PublicKey> calculate_optimal_path(
+        const RouterState& state,
         const PublicKey& source,
         const PublicKey& dest,
         const std::vector<PublicKey>& available_nodes
     );
+    static std::vector<uint8_t> allowed_mask(const RouterState& state, const std::vector<PublicKey>& network_nodes);
     
 public:
     AIRouter();
     
+    AIRouter(const AIRouter&) = delete;
+    AIRouter& operator=(const AIRouter&) = delete;
+    
+    // Yazıcılar: kendi aralarında sıralanır, okuyucuları bekletmez
+    uint32_t add_node(const PublicKey& node);
+    // Çift yönlü bağlantı; tekrar eklenirse gecikme güncellenir
+    void add_link(const PublicKey& a, const PublicKey& b, double latency = 0.0);
+    // Metrikler sütunlara yazılır; maliyet yayında parça başına toplu hesaplanır
     void update_metrics(const PublicKey& node, const NetworkMetrics& metrics);
+    void update_metrics(const std::vector<std::pair<PublicKey, NetworkMetrics>>& batch);
+    void learn(const std::vector<PublicKey>& path, double reward);
+    // Yol başına ödül (ör. çok yollu gönderimde her yolun kendi gecikmesi); tek kilitte
+    void learn(const std::vector<PathFeedback>& feedback);
+    // Bekleyen yazımları hemen yayınlar (toplu güncellemeden sonra)
+    void publish();
+    
+    // Mevcut topolojiden hiyerarşi kurar ve yayınlar. Dolgu max_arcs_per_link
+    // x bağlantı sayısını aşarsa (ör. rastgele kısa yollu genişleyen graflar)
+    // vazgeçer ve false döner; yönlendirme Dijkstra ile sürer. Hiyerarşide
+    // olmayan bir bağlantı eklemek hiyerarşiyi düşürür.
+    bool prepare_hierarchy(size_t max_arcs_per_link = 24);
+    void drop_hierarchy();
+    HierarchyStats hierarchy_stats();
+    
+    // Okuyucular: her thread'den kilitsiz çağrılabilir
+    size_t node_count();
+    size_t link_count();
+    // Grafın tamamı üzerinde, önbellekli; yol yoksa boş
+    std::vector<PublicKey> find_route(const PublicKey& source, const PublicKey& dest);
+    // network_nodes dışındaki düğümler kullanılmaz (boşsa find_route)
     std::vector<PublicKey> find_optimal_route(
         const Transaction& tx,
         const std::vector<PublicKey>& network_nodes
     );
-    void learn(const std::vector<PublicKey>& path, double reward);
+    // Toplu yönlendirme: işlemler kaynağa göre gruplanır, her farklı kaynak
+    // için tek bir en kısa yol ağacı kurulur ve tüm hedefleri ondan okunur.
+    // Sonuç i, txs[i] içindir; tüm toplu iş aynı görüntüye karşı çözülür.
+    // Önbellek kullanılmaz, yollar görüntüdeki tam en kısa yollardır.
+    std::vector<std::vector<PublicKey>> find_optimal_routes(
+        const std::vector<Transaction>& txs,
+        const std::vector<PublicKey>& network_nodes
+    );
+    // Yen: en fazla k döngüsüz yol, artan maliyetle; ilki find_route ile aynı
+    // maliyettedir. Yollar düğüm paylaşabilir (yedek değil, alternatif).
+    std::vector<std::vector<PublicKey>> k_shortest_routes(const PublicKey& source, const PublicKey& dest, size_t k);
+    // Ara düğümleri ortak olmayan en fazla max_paths yol, toplam maliyeti en
+    // küçük (düğüm bölmeli min-cost flow, Suurballe). Yük parçalara bölünüp ya
+    // da yedekli gönderilebilir: bir rölenin yavaşlığı yalnızca bir yolu etkiler.
+    std::vector<std::vector<PublicKey>> disjoint_routes(const PublicKey& source, const PublicKey& dest, size_t max_paths);
+    // Öğrenilmemiş kenar ya da bilinmeyen düğüm: 0
+    double q_value(const PublicKey& from, const PublicKey& to);
+    size_t q_entries();
+    
+    // threshold: göreli maliyet / Q indirimi sapması; capacity: kayıt sınırı
+    // (aşılınca önbellek boşaltılır); max_staleness: kaydın en fazla yaşı (epoch)
+    void configure_route_cache(size_t capacity, double threshold = 0.1, uint64_t max_staleness = 64);
+    RouteCacheStats route_cache_stats();
+    
+    // Çok faktörlü maliyet çekirdeği (gecikme %40, kayıp %30, 1/bant genişliği
+    // %20, itibar %10), sütunlar üzerinde; SSE2 ile iki düğüm birden. Sonuç
+    // skaler formülle bit düzeyinde aynıdır.
+    static void evaluate_costs(const double* latency, const double* loss, const double* bandwidth,
+                               const double* reputation, double* cost, size_t count);
+};
+
+// ============================================================================
+// JSON-RPC İSTEMCİSİ
+// ============================================================================
+
+struct RpcClientConfig {
+    size_t connections;             // havuzdaki kalıcı (keep-alive) bağlantı
+    size_t max_batch;               // tek POST'ta JSON-RPC batch dizisindeki çağrı
+    size_t pipeline_depth;          // bağlantı başına yanıtı beklenen POST
+    size_t max_in_flight;           // tüm bağlantılarda telde olan çağrı üst sınırı
+    uint32_t timeout_ms;            // bağlantı, gönderme ve okuma zaman aşımı
+    uint32_t max_attempts;          // bağlantı hatasında çağrı başına deneme
+    
+    RpcClientConfig()
+        : connections(4), max_batch(32), pipeline_depth(4), max_in_flight(256),
+          timeout_ms(5000), max_attempts(2) {}
+};
+
+struct RpcResponse {
+    bool ok;
+    std::string result;             // ham JSON değeri (ör. "\"ab12\"" ya da {...})
+    std::string error;              // ok değilse: JSON-RPC hata nesnesi ya da bağlantı hatası
+    
+    RpcResponse() : ok(false) {}
+};
+
+struct RpcClientStats {
+    uint64_t calls;
+    uint64_t posts;                 // HTTP istekleri (batch başına bir)
+    uint64_t connects;
+    uint64_t retries;
+    uint64_t failures;
+    size_t peak_in_flight;
+    
+    RpcClientStats() : calls(0), posts(0), connects(0), retries(0), failures(0), peak_in_flight(0) {}
+};
+
+// HTTP/1.1 üzerinden asenkron JSON-RPC. call() hemen future döner; çağrılar
+// ortak kuyruğa girer ve havuzdaki bağlantı thread'leri onları max_batch'lik
+// JSON-RPC batch'leri halinde POST eder. Her bağlantı yanıt beklemeden
+// pipeline_depth POST'a kadar yazar (HTTP pipelining, yanıtlar sırayla
+// gelir) ve yanıtları id ile eşler. Telde max_in_flight'tan fazla çağrı
+// olmaz; fazlası kuyrukta bekler. Bağlantı koparsa yanıtı gelmemiş çağrılar
+// yeni bağlantıda yeniden denenir (yalnızca okuma çağrıları için uygundur).
+//
+// endpoint "http://host:port" biçimindedir; bağlantılar ilk çağrıda açılır.
+class RpcClient {
+private:
+    struct PendingCall {
+        uint64_t id;
+        std::string method;
+        std::string params;         // ham JSON dizisi
+        uint32_t attempts;
+        std::promise<RpcResponse> promise;
+    };
+    
+    std::string host;
+    uint16_t port;
+    RpcClientConfig config;
+    
+    std::vector<std::thread> connections;
+    std::mutex queue_mutex;
+    std::condition_variable queue_cv;
+    std::deque<PendingCall> queue;
+    size_t in_flight;
+    bool stopping;
+    uint64_t next_id;
+    
+    std::atomic<uint64_t> posts;
+    std::atomic<uint64_t> connects;
+    std::atomic<uint64_t> retries;
+    std::atomic<uint64_t> failures;
+    size_t peak_in_flight;          // queue_mutex altında
+    
+    void connection_loop();
+    int open_connection();
+    // Başarısız POST'un çağrıları: deneme hakkı varsa kuyruğun başına döner
+    void fail_batch(std::vector<PendingCall>& batch, const std::string& reason);
+    
+public:
+    RpcClient(const std::string& endpoint, const RpcClientConfig& config = RpcClientConfig());
+    ~RpcClient();
+    
+    RpcClient(const RpcClient&) = delete;
+    RpcClient& operator=(const RpcClient&) = delete;
+    
+    // params: JSON dizisi (ör. ["ab12", true]); method kaçış gerektirmemeli
+    std::future<RpcResponse> call(const std::string& method, const std::string& params);
+    RpcClientStats stats();
+    
+    // "http://host:port" -> host, port; biçim hatalıysa false
+    static bool parse_endpoint(const std::string& endpoint, std::string& host, uint16_t& port);
 };
 
 // ============================================================================
@@ -272,12 +2048,27 @@ public:
         
         virtual Transaction parse_native_tx(const std::vector<uint8_t>& raw_tx) = 0;
         virtual std::vector<uint8_t> encode_to_native(const Transaction& tx) = 0;
+        
+        // Yerel işlemi getiren JSON-RPC çağrısı ve sonucun ham baytlara çevrilmesi.
+        // Varsayılan: params ["<hex>"], sonuç "<hex>" ya da "0x<hex>" dizgesi.
+        virtual std::string rpc_method() const = 0;
+        virtual std::string rpc_params(const Hash256& native_tx_hash) const;
+        virtual bool decode_rpc_result(const std::string& result, std::vector<uint8_t>& raw_tx) const;
         virtual ~ChainAdapter() = default;
     };
 
 private:
     std::unordered_map<ChainType, std::unique_ptr<ChainAdapter>> adapters;
     
+    // Adaptör başına istemci, ilk çekişte rpc_endpoint'e açılır. Çağıranlar
+    // kilit altında alınmış bir kopya tutar: configure_rpc eski istemciyi
+    // haritadan çıkarsa da kullanımda olan istemci son kopyayla kapanır.
+    std::unordered_map<ChainType, std::shared_ptr<RpcClient>> rpc_clients;
+    std::unordered_map<ChainType, RpcClientConfig> rpc_configs;
+    std::mutex rpc_mutex;
+    
+    std::shared_ptr<RpcClient> rpc_client(ChainType type);
+    
     struct BridgeValidator {
         PublicKey key;
         uint64_t stake;
@@ -285,7 +2076,7 @@ private:
     };
     
     std::vector<BridgeValidator> validators;
-    std::unordered_map<Hash256, Transaction> pending_bridge_txs;
+    std::unordered_map<Hash256, Transaction, ArrayHash> pending_bridge_txs;
     
 public:
     CrossChainBridge();
@@ -294,7 +2085,19 @@ public:
     Hash256 initiate_transfer(const Transaction& tx);
     bool confirm_transfer(const Hash256& tx_id, 
                          const std::vector<Signature>& validator_sigs);
+    
+    // Bulunamayan, çözülemeyen ya da RPC'si başarısız işlem boş Transaction döner
     Transaction pull_from_chain(ChainType type, const Hash256& native_tx_hash);
+    std::future<Transaction> pull_from_chain_async(ChainType type, const Hash256& native_tx_hash);
+    // Toplu alım: tüm çekişler aynı anda yola çıkar (batch + pipelining, adaptör
+    // istemcisinin eşzamanlılık sınırı içinde); sonuç i, native_tx_hashes[i] içindir
+    std::vector<Transaction> pull_from_chain(ChainType type, const std::vector<Hash256>& native_tx_hashes);
+    
+    // Adaptörün uç noktasını ve istemci ayarlarını değiştirir. Açık istemci,
+    // üzerinden başlatılmış çekişlerin future'ları tamamlanınca kapanır.
+    void configure_rpc(ChainType type, const std::string& endpoint,
+                       const RpcClientConfig& config = RpcClientConfig());
+    RpcClientStats rpc_stats(ChainType type);
 };
 
 // ============================================================================
@@ -311,11 +2114,11 @@ private:
         bool is_healthy;
     };
     
-    std::unordered_map<PublicKey, NodeHealth> node_health_map;
+    std::unordered_map<PublicKey, NodeHealth, ArrayHash> node_health_map;
     std::mutex health_mutex;
     
     bool detect_anomaly(const NodeHealth& health);
-    std::unordered_map<PublicKey, std::vector<PublicKey>> network_graph;
+    std::unordered_map<PublicKey, std::vector<PublicKey>, ArrayHash> network_graph;
     
     void activate_backup_nodes(const std::vector<PublicKey>& failed_nodes);
     
@@ -345,6 +2148,8 @@ private:
     std::unique_ptr<MerkleDAG> dag;
     std::unique_ptr<AdaptiveConsensus> consensus;
     std::unique_ptr<FractalSharding> sharding;
+    std::unique_ptr<BatchExecutor> executor;
+    std::unique_ptr<WriteAheadLog> journal;
     std::unique_ptr<AIRouter> router;
     std::unique_ptr<CrossChainBridge> bridge;
     std::unique_ptr<SelfHealingNetwork> healing;
@@ -364,6 +2169,7 @@ private:
     };
     
     PerformanceMetrics metrics;
+    std::atomic<uint64_t> batch_height;   // yayınlanan son state görüntüsü
     
     std::atomic<bool> running;
     std::thread tx_processor_thread;
@@ -379,6 +2185,8 @@ public:
     ~HyperLayerNode();
     
     bool initialize(uint16_t port);
+    // start()'tan önce: diskteki state'i kurtarır ve sonraki batch'leri log'lar
+    bool enable_durability(const DurabilityConfig& config);
     void start();
     void stop();
     
@@ -391,6 +2199,9 @@ public:
     }
     bool connect_to_peer(const std::string& ip, uint16_t port);
     uint64_t get_balance(const Address& addr, uint32_t shard_id);
+    // height = 0: son yayınlanan görüntü; aksi halde son SNAPSHOT_HISTORY yükseklikten biri
+    std::shared_ptr<const StateSnapshot> get_state_snapshot(uint64_t height = 0) const;
+    TelemetrySnapshot get_shard_telemetry(bool reset = false);
 };
 
 } // namespace HyperLayer
@@ -8,6 +8,16 @@
 #include <cmath>
 #include <iostream>
 #include <limits>
+#include <queue>
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
 
 namespace HyperLayer {
 
@@ -15,139 +25,2175 @@ namespace HyperLayer {
 // AI-OPTIMIZED ROUTING İMPLEMENTASYONU
 // ============================================================================
 
+namespace {
+constexpr uint32_t NO_NODE = std::numeric_limits<uint32_t>::max();
+
+// Eski çok faktörlü maliyet: gecikme %40, kayıp %30, bant genişliği %20, itibar %10
+double metrics_cost(double latency, double loss, double bandwidth, double reputation) {
+    double cost = latency * 0.4 +
+                  loss * 100.0 * 0.3 +
+                  (1.0 / bandwidth) * 0.2 +
+                  (1.0 - reputation) * 0.1;
+    return std::max(0.0, cost);
+}
+
+// Q değeri maliyeti düşürür; Dijkstra için negatif kenar olmamalı
+double q_discount(double q) {
+    return std::max(0.0, 1.0 - q * 0.2);
+}
+
+// İşlem adresleri (20 bayt) düğüm anahtarına sıfır dolgulu kopyalanır
+PublicKey endpoint_key(const Address& address) {
+    PublicKey key{};
+    std::memcpy(key.data(), address.data(), std::min(key.size(), address.size()));
+    return key;
+}
+}
+
 AIRouter::AIRouter() 
-    : learning_rate(0.1), discount_factor(0.95) {}
+    : index_owned(false), dirty(false), change_threshold(0.1),
+      learning_rate(0.1), discount_factor(0.95),
+      cache_hits(0), cache_misses(0), cache_recomputes(0), cache_invalidations(0) {
+    
+    auto initial = std::make_shared<RouterState>();
+    initial->index = std::make_shared<NodeIndex>();
+    initial->edges.fill(std::make_shared<EdgeShard>());    // boş parça hepsinde ortak
+    initial->node_count = 0;
+    initial->links = 0;
+    initial->q_entries = 0;
+    initial->epoch = 0;
+    initial->topology_epoch = 0;
+    initial->max_staleness = 64;
+    initial->cache_capacity = 4096;
+    
+    current = initial;
+    draft = std::make_shared<RouterState>(*initial);
+    edge_owned.fill(0);
+}
+
+bool AIRouter::RouterState::lookup(const PublicKey& node, uint32_t& out) const {
+    auto it = index->find(node);
+    if (it == index->end()) {
+        return false;
+    }
+    out = it->second;
+    return true;
+}
+
+const AIRouter::EdgeState* AIRouter::RouterState::edge(uint64_t key) const {
+    const EdgeShard& shard = *edges[edge_shard(key)];
+    if (shard.empty()) {
+        return nullptr;
+    }
+    auto it = shard.find(key);
+    return it == shard.end() ? nullptr : &it->second;
+}
+
+// Taslak parçalar yayınlanmış görüntüyle paylaşılır; ilk yazımda kopyalanır.
+// Kopya taslağa aittir ve henüz yayınlanmadığı için const_cast güvenlidir.
+AIRouter::MetricChunk& AIRouter::writable_metrics(uint32_t node) {
+    uint32_t chunk = node >> CHUNK_BITS;
+    if (!metric_owned[chunk]) {
+        draft->metrics[chunk] = std::make_shared<MetricChunk>(*draft->metrics[chunk]);
+        metric_owned[chunk] = 1;
+    }
+    return const_cast<MetricChunk&>(*draft->metrics[chunk]);
+}
+
+AIRouter::TopologyChunk& AIRouter::writable_topology(uint32_t node) {
+    uint32_t chunk = node >> CHUNK_BITS;
+    if (!topology_owned[chunk]) {
+        draft->topology[chunk] = std::make_shared<TopologyChunk>(*draft->topology[chunk]);
+        topology_owned[chunk] = 1;
+    }
+    return const_cast<TopologyChunk&>(*draft->topology[chunk]);
+}
+
+AIRouter::EdgeState& AIRouter::writable_edge(uint64_t key) {
+    uint32_t index = edge_shard(key);
+    if (!edge_owned[index]) {
+        draft->edges[index] = std::make_shared<EdgeShard>(*draft->edges[index]);
+        edge_owned[index] = 1;
+    }
+    EdgeShard& shard = const_cast<EdgeShard&>(*draft->edges[index]);
+    
+    auto it = shard.find(key);
+    if (it != shard.end()) {
+        return it->second;
+    }
+    // Öğrenilmemiş kenarın indirimi 1.0
+    EdgeState& edge = shard[key];
+    edge = EdgeState{0.0, false, ChangeStamp{0, 1.0}};
+    return edge;
+}
+
+uint32_t AIRouter::intern(const PublicKey& node) {
+    uint32_t index;
+    if (draft->lookup(node, index)) {
+        return index;
+    }
+    
+    index = static_cast<uint32_t>(draft->node_count);
+    uint32_t slot = index & (CHUNK_NODES - 1);
+    if (slot == 0) {
+        auto metrics = std::make_shared<MetricChunk>();
+        metrics->latency.fill(0.0);
+        metrics->loss.fill(0.0);
+        metrics->bandwidth.fill(1.0);
+        metrics->reputation.fill(1.0);
+        metrics->cost.fill(1.0);
+        metrics->stamps.fill(ChangeStamp{0, 1.0});
+        metrics->stale.fill(0);
+        draft->metrics.push_back(metrics);
+        draft->topology.push_back(std::make_shared<TopologyChunk>());
+        metric_owned.push_back(1);
+        topology_owned.push_back(1);
+    }
+    
+    if (!index_owned) {
+        draft->index = std::make_shared<NodeIndex>(*draft->index);
+        index_owned = true;
+    }
+    const_cast<NodeIndex&>(*draft->index)[node] = index;
+    writable_topology(index).keys[slot] = node;
+    ++draft->node_count;
+    dirty.store(true, std::memory_order_release);
+    return index;
+}
+
+void AIRouter::evaluate_costs(const double* latency, const double* loss, const double* bandwidth,
+                              const double* reputation, double* cost, size_t count) {
+    size_t i = 0;
+#if defined(__SSE2__)
+    // İşlem sırası skaler formülle aynı: sonuçlar bit düzeyinde eşleşir
+    const __m128d w_latency = _mm_set1_pd(0.4);
+    const __m128d percent = _mm_set1_pd(100.0);
+    const __m128d w_loss = _mm_set1_pd(0.3);
+    const __m128d w_bandwidth = _mm_set1_pd(0.2);
+    const __m128d w_reputation = _mm_set1_pd(0.1);
+    const __m128d one = _mm_set1_pd(1.0);
+    const __m128d zero = _mm_setzero_pd();
+    for (; i + 2 <= count; i += 2) {
+        __m128d sum = _mm_mul_pd(_mm_loadu_pd(latency + i), w_latency);
+        sum = _mm_add_pd(sum, _mm_mul_pd(_mm_mul_pd(_mm_loadu_pd(loss + i), percent), w_loss));
+        sum = _mm_add_pd(sum, _mm_mul_pd(_mm_div_pd(one, _mm_loadu_pd(bandwidth + i)), w_bandwidth));
+        sum = _mm_add_pd(sum, _mm_mul_pd(_mm_sub_pd(one, _mm_loadu_pd(reputation + i)), w_reputation));
+        // maxpd(x, 0): x NaN ise 0, std::max(0.0, x) gibi
+        _mm_storeu_pd(cost + i, _mm_max_pd(sum, zero));
+    }
+#endif
+    for (; i < count; ++i) {
+        cost[i] = metrics_cost(latency[i], loss[i], bandwidth[i], reputation[i]);
+    }
+}
+
+void AIRouter::refresh_costs() {
+    std::array<double, CHUNK_NODES> fresh;
+    for (uint32_t index : stale_chunks) {
+        MetricChunk& chunk = writable_metrics(index << CHUNK_BITS);
+        
+        // Parçanın tamamı tek geçişte; metriği olmayan yuvaların sonucu kullanılmaz
+        evaluate_costs(chunk.latency.data(), chunk.loss.data(), chunk.bandwidth.data(),
+                       chunk.reputation.data(), fresh.data(), CHUNK_NODES);
+        for (size_t word = 0; word < chunk.stale.size(); ++word) {
+            for (uint64_t bits = chunk.stale[word]; bits != 0; bits &= bits - 1) {
+                uint32_t slot = static_cast<uint32_t>(word * 64 + __builtin_ctzll(bits));
+                chunk.cost[slot] = fresh[slot];
+                stamp_change(chunk.stamps[slot], fresh[slot]);
+                if (draft->hierarchy) {
+                    hierarchy_nodes.push_back(index << CHUNK_BITS | slot);
+                }
+            }
+            chunk.stale[word] = 0;
+        }
+    }
+    stale_chunks.clear();
+}
+
+void AIRouter::publish_locked() {
+    refresh_costs();
+    
+    // Bekleyen metrik/Q değişiklikleri yalnızca etkilenen yaylara işlenir
+    if (draft->hierarchy && (!hierarchy_nodes.empty() || !hierarchy_edges.empty())) {
+        auto hierarchy = std::make_shared<Hierarchy>(*draft->hierarchy);
+        hierarchy_info.recustomized_arcs += recustomize(*draft, *hierarchy);
+        ++hierarchy_info.recustomizations;
+        draft->hierarchy = hierarchy;
+    }
+    
+    std::atomic_store(&current, std::shared_ptr<const RouterState>(draft));
+    
+    // Yeni taslak yalnızca parça işaretçilerini kopyalar
+    draft = std::make_shared<RouterState>(*draft);
+    std::fill(metric_owned.begin(), metric_owned.end(), 0);
+    std::fill(topology_owned.begin(), topology_owned.end(), 0);
+    edge_owned.fill(0);
+    index_owned = false;
+    dirty.store(false, std::memory_order_release);
+}
+
+void AIRouter::publish() {
+    std::lock_guard<std::mutex> lock(write_mutex);
+    if (dirty.load(std::memory_order_relaxed)) {
+        publish_locked();
+    }
+}
+
+void AIRouter::note_hierarchy_edge(uint32_t from, uint32_t to) {
+    if (draft->hierarchy) {
+        hierarchy_edges.push_back(edge_key(from, to));
+    }
+}
+
+std::shared_ptr<const AIRouter::RouterState> AIRouter::view() {
+    if (dirty.load(std::memory_order_acquire)) {
+        // Yazıcı kilitteyse beklemeden mevcut görüntüyle devam et
+        std::unique_lock<std::mutex> lock(write_mutex, std::try_to_lock);
+        if (lock.owns_lock() && dirty.load(std::memory_order_relaxed)) {
+            publish_locked();
+        }
+    }
+    return std::atomic_load(&current);
+}
+
+uint32_t AIRouter::add_node(const PublicKey& node) {
+    std::lock_guard<std::mutex> lock(write_mutex);
+    return intern(node);
+}
+
+void AIRouter::add_link(const PublicKey& a, const PublicKey& b, double latency) {
+    std::lock_guard<std::mutex> lock(write_mutex);
+    uint32_t u = intern(a);
+    uint32_t v = intern(b);
+    if (u == v) {
+        return;
+    }
+    
+    auto connect = [this, latency](uint32_t from, uint32_t to) {
+        auto& list = writable_topology(from).adjacency[from & (CHUNK_NODES - 1)];
+        for (auto& link : list) {
+            if (link.to == to) {
+                // Gecikme değişikliği eşiği aşarsa yalnızca bu kenarı kullanan rotalar düşer
+                double scale = std::max(std::abs(link.latency), 1e-9);
+                if (std::abs(latency - link.latency) > change_threshold * scale) {
+                    writable_edge(edge_key(from, to)).stamp.epoch = ++draft->epoch;
+                    cache_invalidations.fetch_add(1, std::memory_order_relaxed);
+                }
+                link.latency = latency;
+                note_hierarchy_edge(from, to);
+                return false;
+            }
+        }
+        list.push_back(Link{to, latency});
+        return true;
+    };
+    
+    if (connect(u, v)) {
+        ++draft->links;
+        draft->topology_epoch = ++draft->epoch;    // yeni kenar her rotayı kısaltabilir
+        
+        // Dolguda zaten olan yay yalnızca yeniden özelleştirilir; yoksa hiyerarşi geçersiz
+        if (draft->hierarchy) {
+            const HierarchyTopology& topology = *draft->hierarchy->topology;
+            if (u < topology.nodes() && v < topology.nodes() &&
+                topology.find_arc(std::min(topology.rank[u], topology.rank[v]),
+                                  std::max(topology.rank[u], topology.rank[v])) != UINT32_MAX) {
+                note_hierarchy_edge(u, v);
+                note_hierarchy_edge(v, u);
+            } else {
+                draft->hierarchy.reset();
+                hierarchy_nodes.clear();
+                hierarchy_edges.clear();
+                hierarchy_info.active = false;
+            }
+        }
+    }
+    connect(v, u);
+    dirty.store(true, std::memory_order_release);
+}
+
+void AIRouter::set_metrics(uint32_t node, const NetworkMetrics& metrics) {
+    uint32_t slot = node & (CHUNK_NODES - 1);
+    MetricChunk& chunk = writable_metrics(node);
+    chunk.latency[slot] = metrics.avg_latency;
+    chunk.loss[slot] = metrics.packet_loss;
+    chunk.bandwidth[slot] = metrics.bandwidth;
+    chunk.reputation[slot] = metrics.node_reputation;
+    
+    bool waiting = false;
+    for (uint64_t word : chunk.stale) {
+        waiting |= word != 0;
+    }
+    if (!waiting) {
+        stale_chunks.push_back(node >> CHUNK_BITS);
+    }
+    chunk.stale[slot / 64] |= uint64_t(1) << (slot % 64);
+}
 
 void AIRouter::update_metrics(const PublicKey& node, const NetworkMetrics& metrics) {
-    node_metrics[node] = metrics;
+    std::lock_guard<std::mutex> lock(write_mutex);
+    set_metrics(intern(node), metrics);
+    dirty.store(true, std::memory_order_release);
+}
+
+void AIRouter::update_metrics(const std::vector<std::pair<PublicKey, NetworkMetrics>>& batch) {
+    std::lock_guard<std::mutex> lock(write_mutex);
+    for (const auto& entry : batch) {
+        set_metrics(intern(entry.first), entry.second);
+    }
+    if (!batch.empty()) {
+        dirty.store(true, std::memory_order_release);
+    }
+}
+
+bool AIRouter::stamp_change(ChangeStamp& stamp, double value) {
+    double scale = std::max(std::abs(stamp.baseline), 1e-9);
+    if (std::abs(value - stamp.baseline) <= change_threshold * scale) {
+        return false;
+    }
+    stamp.baseline = value;
+    stamp.epoch = ++draft->epoch;
+    cache_invalidations.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+bool AIRouter::route_fresh(const RouterState& state, const CachedRoute& route) {
+    // Kayıt bu görüntüden yeni bir görüntüde hesaplandıysa zaten güncel
+    if (route.epoch >= state.epoch) {
+        return true;
+    }
+    if (route.epoch < state.topology_epoch || state.epoch - route.epoch > state.max_staleness) {
+        return false;
+    }
+    
+    // Kaynak düğümün maliyeti yola girmez
+    for (size_t i = 1; i < route.hops.size(); ++i) {
+        uint32_t hop = route.hops[i];
+        if (state.metric_chunk(hop).stamps[hop & (CHUNK_NODES - 1)].epoch > route.epoch) {
+            return false;
+        }
+        const EdgeState* edge = state.edge(edge_key(route.hops[i - 1], hop));
+        if (edge && edge->stamp.epoch > route.epoch) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void AIRouter::configure_route_cache(size_t capacity, double threshold, uint64_t staleness) {
+    {
+        std::lock_guard<std::mutex> lock(write_mutex);
+        draft->cache_capacity = capacity;
+        draft->max_staleness = staleness;
+        change_threshold = threshold;
+        publish_locked();
+    }
+    for (auto& shard : cache) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.routes.clear();
+    }
+}
+
+AIRouter::RouteCacheStats AIRouter::route_cache_stats() {
+    RouteCacheStats stats;
+    stats.hits = cache_hits.load(std::memory_order_relaxed);
+    stats.misses = cache_misses.load(std::memory_order_relaxed);
+    stats.recomputes = cache_recomputes.load(std::memory_order_relaxed);
+    stats.invalidations = cache_invalidations.load(std::memory_order_relaxed);
+    for (auto& shard : cache) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        stats.entries += shard.routes.size();
+    }
+    return stats;
+}
+
+size_t AIRouter::node_count() {
+    return view()->node_count;
+}
+
+size_t AIRouter::link_count() {
+    return view()->links;
+}
+
+size_t AIRouter::q_entries() {
+    return view()->q_entries;
+}
+
+double AIRouter::edge_weight(const RouterState& state, uint32_t from, uint32_t to) {
+    for (const auto& link : state.topology_chunk(from).adjacency[from & (CHUNK_NODES - 1)]) {
+        if (link.to == to) {
+            return link.latency + step_cost(state, from, to);
+        }
+    }
+    return std::numeric_limits<double>::infinity();
+}
+
+double AIRouter::step_cost(const RouterState& state, uint32_t from, uint32_t to) {
+    double cost = state.metric_chunk(to).cost[to & (CHUNK_NODES - 1)];
+    
+    // Q-learning enhancement
+    if (state.q_entries != 0) {
+        const EdgeState* edge = state.edge(edge_key(from, to));
+        if (edge && edge->learned) {
+            cost *= q_discount(edge->q);
+        }
+    }
+    return cost;
+}
+
+void AIRouter::shortest_tree(const RouterState& state, uint32_t source, const std::vector<uint32_t>& targets,
+                             const std::vector<uint8_t>& allowed,
+                             std::vector<double>& distance, std::vector<uint32_t>& previous,
+                             const EdgeSet* blocked) {
+    const double inf = std::numeric_limits<double>::infinity();
+    distance.assign(state.node_count, inf);
+    previous.assign(state.node_count, NO_NODE);
+    
+    // Bekleyen hedefler; hepsi kesinleşince ağacın kalanı gereksiz
+    std::vector<uint8_t> pending(state.node_count, 0);
+    size_t remaining = 0;
+    for (uint32_t target : targets) {
+        if (!pending[target]) {
+            pending[target] = 1;
+            ++remaining;
+        }
+    }
+    
+    // Tembel silmeli ikili heap: eskimiş girdiler çekildiğinde atlanır
+    using HeapItem = std::pair<double, uint32_t>;
+    std::priority_queue<HeapItem, std::vector<HeapItem>, std::greater<HeapItem>> heap;
+    distance[source] = 0.0;
+    heap.emplace(0.0, source);
+    
+    while (!heap.empty()) {
+        auto [d, u] = heap.top();
+        heap.pop();
+        if (d > distance[u]) {
+            continue;
+        }
+        if (pending[u]) {
+            pending[u] = 0;
+            if (--remaining == 0) {
+                break;
+            }
+        }
+        
+        for (const auto& link : state.topology_chunk(u).adjacency[u & (CHUNK_NODES - 1)]) {
+            if (!allowed.empty() && !allowed[link.to]) {
+                continue;
+            }
+            if (blocked && !blocked->empty() && blocked->find(edge_key(u, link.to)) != blocked->end()) {
+                continue;
+            }
+            double alt = d + link.latency + step_cost(state, u, link.to);
+            if (alt < distance[link.to]) {
+                distance[link.to] = alt;
+                previous[link.to] = u;
+                heap.emplace(alt, link.to);
+            }
+        }
+    }
+}
+
+bool AIRouter::extract_path(const std::vector<double>& distance, const std::vector<uint32_t>& previous,
+                            uint32_t dest, std::vector<uint32_t>& hops) {
+    hops.clear();
+    if (distance[dest] == std::numeric_limits<double>::infinity()) {
+        return false; // No path found
+    }
+    
+    for (uint32_t at = dest; at != NO_NODE; at = previous[at]) {
+        hops.push_back(at);
+    }
+    std::reverse(hops.begin(), hops.end());
+    return true;
+}
+
+bool AIRouter::shortest_path(const RouterState& state, uint32_t source, uint32_t dest,
+                             const std::vector<uint8_t>& allowed, std::vector<uint32_t>& hops) {
+    std::vector<double> distance;
+    std::vector<uint32_t> previous;
+    shortest_tree(state, source, {dest}, allowed, distance, previous);
+    return extract_path(distance, previous, dest, hops);
+}
+
+bool AIRouter::route_hops(const RouterState& state, uint32_t source, uint32_t dest, std::vector<uint32_t>& hops) {
+    if (state.hierarchy && hierarchy_route(state, source, dest, hops)) {
+        return !hops.empty();
+    }
+    return shortest_path(state, source, dest, {}, hops);
+}
+
+std::vector<PublicKey> AIRouter::to_keys(const RouterState& state, const std::vector<uint32_t>& hops) {
+    std::vector<PublicKey> path;
+    path.reserve(hops.size());
+    for (uint32_t hop : hops) {
+        path.push_back(state.key(hop));
+    }
+    return path;
+}
+
+std::vector<std::vector<PublicKey>> AIRouter::calculate_optimal_paths(
+    const RouterState& state,
+    const PublicKey& source,
+    const std::vector<PublicKey>& dests,
+    const std::vector<PublicKey>& available_nodes) {
+    
+    std::vector<std::vector<PublicKey>> paths(dests.size());
+    
+    // Listeye yerel yoğun indeksler; metrik maliyeti düğüm başına bir kez çözülür
+    const size_t n = available_nodes.size();
+    const double inf = std::numeric_limits<double>::infinity();
+    std::vector<double> cost(n, 1.0);
+    std::vector<uint32_t> global(n, NO_NODE);
+    FlatMap<PublicKey, uint32_t, DigestHash> position;
+    size_t s = n;
+    for (size_t i = 0; i < n; ++i) {
+        if (state.lookup(available_nodes[i], global[i])) {
+            cost[i] = state.metric_chunk(global[i]).cost[global[i] & (CHUNK_NODES - 1)];
+        }
+        if (s == n && available_nodes[i] == source) {
+            s = i;
+        }
+        if (!dests.empty() && position.find(available_nodes[i]) == position.end()) {
+            position[available_nodes[i]] = static_cast<uint32_t>(i);
+        }
+    }
+    
+    // Hedeflerin listedeki ilk konumu; kaynağın kendisi ya da listede olmayan hedef taranmaz
+    std::vector<size_t> target(dests.size(), n);
+    std::vector<uint8_t> pending(n, 0);
+    size_t remaining = 0;
+    for (size_t d = 0; d < dests.size(); ++d) {
+        if (dests[d] == source) {
+            paths[d] = {source};
+            continue;
+        }
+        auto it = position.find(dests[d]);
+        if (s == n || it == position.end()) {
+            continue;
+        }
+        target[d] = it->second;
+        if (!pending[target[d]]) {
+            pending[target[d]] = 1;
+            ++remaining;
+        }
+    }
+    if (remaining == 0) {
+        return paths;
+    }
+    
+    std::vector<double> distance(n, inf);
+    std::vector<uint32_t> previous(n, NO_NODE);
+    std::vector<uint8_t> done(n, 0);
+    distance[s] = 0.0;
+    
+    for (size_t round = 0; round < n; ++round) {
+        size_t u = n;
+        for (size_t i = 0; i < n; ++i) {
+            if (!done[i] && (u == n || distance[i] < distance[u])) {
+                u = i;
+            }
+        }
+        if (u == n || distance[u] == inf) {
+            break;
+        }
+        done[u] = 1;
+        if (pending[u]) {
+            pending[u] = 0;
+            if (--remaining == 0) {
+                break;
+            }
+        }
+        
+        for (size_t v = 0; v < n; ++v) {
+            if (done[v]) {
+                continue;
+            }
+            double step = cost[v];
+            if (global[u] != NO_NODE && global[v] != NO_NODE) {
+                step = step_cost(state, global[u], global[v]);
+            }
+            double alt = distance[u] + step;
+            if (alt < distance[v]) {
+                distance[v] = alt;
+                previous[v] = static_cast<uint32_t>(u);
+            }
+        }
+    }
+    
+    for (size_t d = 0; d < dests.size(); ++d) {
+        if (target[d] == n || distance[target[d]] == inf) {
+            continue; // No path found
+        }
+        for (uint32_t at = static_cast<uint32_t>(target[d]); at != NO_NODE; at = previous[at]) {
+            paths[d].push_back(available_nodes[at]);
+        }
+        std::reverse(paths[d].begin(), paths[d].end());
+    }
+    return paths;
 }
 
 std::vector<PublicKey> AIRouter::calculate_optimal_path(
+    const RouterState& state,
     const PublicKey& source,
     const PublicKey& dest,
     const std::vector<PublicKey>& available_nodes) {
     
-    // Dijkstra benzeri ama AI-enhanced
-    std::unordered_map<PublicKey, double, ArrayHash> distances;
-    std::unordered_map<PublicKey, PublicKey, ArrayHash> previous;
-    std::vector<PublicKey> unvisited = available_nodes;
+    return std::move(calculate_optimal_paths(state, source, {dest}, available_nodes)[0]);
+}
+
+std::vector<uint8_t> AIRouter::allowed_mask(const RouterState& state, const std::vector<PublicKey>& network_nodes) {
+    std::vector<uint8_t> allowed(state.node_count, 0);
+    for (const auto& node : network_nodes) {
+        uint32_t index;
+        if (state.lookup(node, index)) {
+            allowed[index] = 1;
+        }
+    }
+    return allowed;
+}
+
+std::vector<PublicKey> AIRouter::cached_route(const RouterState& state,
+                                              const PublicKey& source, const PublicKey& dest) {
+    if (source == dest) {
+        return {source};
+    }
+    
+    uint32_t s, t;
+    if (!state.lookup(source, s) || !state.lookup(dest, t)) {
+        return {};
+    }
+    
+    std::vector<uint32_t> hops;
+    if (state.cache_capacity == 0) {
+        route_hops(state, s, t, hops);
+        return to_keys(state, hops);
+    }
+    
+    uint64_t key = edge_key(s, t);
+    CacheShard& shard = cache[EdgeKeyHash()(key) >> 60];
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.routes.find(key);
+        if (it != shard.routes.end()) {
+            if (route_fresh(state, it->second)) {
+                cache_hits.fetch_add(1, std::memory_order_relaxed);
+                hops = it->second.hops;
+            } else {
+                cache_recomputes.fetch_add(1, std::memory_order_relaxed);
+            }
+        } else {
+            cache_misses.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    if (!hops.empty()) {
+        return to_keys(state, hops);
+    }
+    
+    // Yol hesabı kilit dışında; yol yoksa da kaydedilir (yeni bağlantı eskitir)
+    route_hops(state, s, t, hops);
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.routes.find(key);
+        if (it == shard.routes.end()) {
+            size_t limit = std::max<size_t>(1, state.cache_capacity / CACHE_SHARDS);
+            if (shard.routes.size() >= limit) {
+                shard.routes.clear();
+            }
+            shard.routes[key] = CachedRoute{hops, state.epoch};
+        } else if (it->second.epoch <= state.epoch) {
+            // Daha yeni bir görüntüden yazılmış kaydı ezme
+            it->second = CachedRoute{hops, state.epoch};
+        }
+    }
+    return to_keys(state, hops);
+}
+
+std::vector<PublicKey> AIRouter::find_route(const PublicKey& source, const PublicKey& dest) {
+    return cached_route(*view(), source, dest);
+}
+
+std::vector<PublicKey> AIRouter::find_optimal_route(
+    const Transaction& tx,
+    const std::vector<PublicKey>& network_nodes) {
+    
+    PublicKey source = endpoint_key(tx.from);
+    PublicKey dest = endpoint_key(tx.to);
     
-    // Initialize distances
-    for (const auto& node : available_nodes) {
-        distances[node] = std::numeric_limits<double>::infinity();
+    auto state = view();
+    if (state->links == 0) {
+        return calculate_optimal_path(*state, source, dest, network_nodes);
+    }
+    if (network_nodes.empty()) {
+        return cached_route(*state, source, dest);
+    }
+    
+    if (source == dest) {
+        return {source};
+    }
+    
+    // Topoloji varsa gerçek kenarlar; yalnızca network_nodes'taki düğümler
+    uint32_t s, t;
+    if (!state->lookup(source, s) || !state->lookup(dest, t)) {
+        return {};
+    }
+    std::vector<uint8_t> allowed = allowed_mask(*state, network_nodes);
+    if (!allowed[s] || !allowed[t]) {
+        return {};
+    }
+    
+    std::vector<uint32_t> hops;
+    shortest_path(*state, s, t, allowed, hops);
+    return to_keys(*state, hops);
+}
+
+std::vector<std::vector<PublicKey>> AIRouter::find_optimal_routes(
+    const std::vector<Transaction>& txs,
+    const std::vector<PublicKey>& network_nodes) {
+    
+    std::vector<std::vector<PublicKey>> routes(txs.size());
+    
+    // Kaynağa göre grupla; gruplar ilk görülme sırasıyla işlenir
+    FlatMap<PublicKey, uint32_t, DigestHash> group_of;
+    std::vector<PublicKey> sources;
+    std::vector<std::vector<size_t>> groups;
+    group_of.reserve(txs.size());
+    for (size_t i = 0; i < txs.size(); ++i) {
+        PublicKey source = endpoint_key(txs[i].from);
+        auto it = group_of.find(source);
+        if (it == group_of.end()) {
+            group_of[source] = static_cast<uint32_t>(groups.size());
+            sources.push_back(source);
+            groups.emplace_back();
+            groups.back().push_back(i);
+        } else {
+            groups[it->second].push_back(i);
+        }
+    }
+    
+    auto state = view();
+    if (state->links == 0) {
+        for (size_t g = 0; g < groups.size(); ++g) {
+            std::vector<PublicKey> dests;
+            dests.reserve(groups[g].size());
+            for (size_t i : groups[g]) {
+                dests.push_back(endpoint_key(txs[i].to));
+            }
+            auto paths = calculate_optimal_paths(*state, sources[g], dests, network_nodes);
+            for (size_t k = 0; k < groups[g].size(); ++k) {
+                routes[groups[g][k]] = std::move(paths[k]);
+            }
+        }
+        return routes;
+    }
+    
+    std::vector<uint8_t> allowed;
+    if (!network_nodes.empty()) {
+        allowed = allowed_mask(*state, network_nodes);
+    }
+    
+    std::vector<double> distance;
+    std::vector<uint32_t> previous;
+    std::vector<uint32_t> targets;
+    std::vector<uint32_t> hops;
+    for (size_t g = 0; g < groups.size(); ++g) {
+        const PublicKey& source = sources[g];
+        uint32_t s = NO_NODE;
+        bool routable = state->lookup(source, s) && (allowed.empty() || allowed[s]);
+        
+        // Hedefin ağaçtaki indeksi; kaynağın kendisi ya da yönlendirilemeyen hedef: NO_NODE
+        targets.clear();
+        std::vector<uint32_t> dest_index(groups[g].size(), NO_NODE);
+        for (size_t k = 0; k < groups[g].size(); ++k) {
+            PublicKey dest = endpoint_key(txs[groups[g][k]].to);
+            uint32_t t;
+            if (dest == source) {
+                routes[groups[g][k]] = {source};
+            } else if (routable && state->lookup(dest, t) && (allowed.empty() || allowed[t])) {
+                dest_index[k] = t;
+                targets.push_back(t);
+            }
+        }
+        if (targets.empty()) {
+            continue;
+        }
+        
+        // Hiyerarşi sorgusu ağaçtan ucuz; karşılayamadığı hedefler ağaca kalır
+        if (allowed.empty() && state->hierarchy) {
+            targets.clear();
+            for (size_t k = 0; k < groups[g].size(); ++k) {
+                if (dest_index[k] == NO_NODE) {
+                    continue;
+                }
+                if (hierarchy_route(*state, s, dest_index[k], hops)) {
+                    routes[groups[g][k]] = to_keys(*state, hops);
+                    dest_index[k] = NO_NODE;
+                } else {
+                    targets.push_back(dest_index[k]);
+                }
+            }
+            if (targets.empty()) {
+                continue;
+            }
+        }
+        
+        shortest_tree(*state, s, targets, allowed, distance, previous);
+        for (size_t k = 0; k < groups[g].size(); ++k) {
+            if (dest_index[k] != NO_NODE && extract_path(distance, previous, dest_index[k], hops)) {
+                routes[groups[g][k]] = to_keys(*state, hops);
+            }
+        }
+    }
+    return routes;
+}
+
+std::vector<std::vector<PublicKey>> AIRouter::k_shortest_routes(const PublicKey& source, const PublicKey& dest, size_t k) {
+    if (k == 0) {
+        return {};
+    }
+    if (source == dest) {
+        return {{source}};
+    }
+    
+    auto state = view();
+    uint32_t s, t;
+    if (!state->lookup(source, s) || !state->lookup(dest, t)) {
+        return {};
+    }
+    
+    std::vector<std::vector<uint32_t>> accepted(1);
+    if (!shortest_path(*state, s, t, {}, accepted[0])) {
+        return {};
+    }
+    
+    struct Candidate {
+        double cost;
+        std::vector<uint32_t> hops;
+    };
+    std::vector<Candidate> candidates;
+    std::vector<uint8_t> allowed(state->node_count, 1);
+    EdgeSet blocked;
+    std::vector<double> distance;
+    std::vector<uint32_t> previous;
+    std::vector<uint32_t> spur_hops;
+    
+    while (accepted.size() < k) {
+        const std::vector<uint32_t> last = accepted.back();
+        double root_cost = 0.0;
+        
+        // Her sapma düğümünde: kök ortak, kökü paylaşan yolların sonraki kenarı
+        // ve kökteki düğümler yasak; kalan en kısa yol aday olur
+        for (size_t i = 0; i + 1 < last.size(); ++i) {
+            blocked.clear();
+            for (const auto& path : accepted) {
+                if (path.size() > i + 1 && std::equal(last.begin(), last.begin() + i + 1, path.begin())) {
+                    blocked[edge_key(path[i], path[i + 1])] = 1;
+                }
+            }
+            for (size_t j = 0; j < i; ++j) {
+                allowed[last[j]] = 0;
+            }
+            
+            shortest_tree(*state, last[i], {t}, allowed, distance, previous, &blocked);
+            if (extract_path(distance, previous, t, spur_hops)) {
+                Candidate candidate;
+                candidate.cost = root_cost + distance[t];
+                candidate.hops.assign(last.begin(), last.begin() + i);
+                candidate.hops.insert(candidate.hops.end(), spur_hops.begin(), spur_hops.end());
+                
+                bool duplicate = std::find(accepted.begin(), accepted.end(), candidate.hops) != accepted.end();
+                for (const auto& other : candidates) {
+                    duplicate = duplicate || other.hops == candidate.hops;
+                }
+                if (!duplicate) {
+                    candidates.push_back(std::move(candidate));
+                }
+            }
+            
+            for (size_t j = 0; j < i; ++j) {
+                allowed[last[j]] = 1;
+            }
+            root_cost += edge_weight(*state, last[i], last[i + 1]);
+        }
+        
+        if (candidates.empty()) {
+            break;
+        }
+        auto best = std::min_element(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+            return a.cost < b.cost || (a.cost == b.cost && a.hops.size() < b.hops.size());
+        });
+        accepted.push_back(std::move(best->hops));
+        candidates.erase(best);
+    }
+    
+    std::vector<std::vector<PublicKey>> routes;
+    for (const auto& hops : accepted) {
+        routes.push_back(to_keys(*state, hops));
+    }
+    return routes;
+}
+
+std::vector<std::vector<PublicKey>> AIRouter::disjoint_routes(const PublicKey& source, const PublicKey& dest, size_t max_paths) {
+    if (max_paths == 0) {
+        return {};
+    }
+    if (source == dest) {
+        return {{source}};
+    }
+    
+    auto state = view();
+    uint32_t s, t;
+    if (!state->lookup(source, s) || !state->lookup(dest, t)) {
+        return {};
+    }
+    
+    // Düğüm bölme: v -> (2v giriş, 2v+1 çıkış), giriş->çıkış kapasitesi 1
+    // (kaynak ve hedefte max_paths). Bağlantı u->v: çıkış(u) -> giriş(v),
+    // kapasite 1. Yaylar çift tutulur, ters yay = yay ^ 1.
+    struct FlowArc {
+        uint32_t to;
+        uint32_t capacity;
+        double cost;
+    };
+    const uint32_t vertices = static_cast<uint32_t>(state->node_count) * 2;
+    std::vector<FlowArc> arcs;
+    std::vector<std::vector<uint32_t>> out(vertices);
+    auto add_arc = [&](uint32_t from, uint32_t to, uint32_t capacity, double cost) {
+        out[from].push_back(static_cast<uint32_t>(arcs.size()));
+        arcs.push_back(FlowArc{to, capacity, cost});
+        out[to].push_back(static_cast<uint32_t>(arcs.size()));
+        arcs.push_back(FlowArc{from, 0, -cost});
+    };
+    for (uint32_t v = 0; v < state->node_count; ++v) {
+        uint32_t capacity = v == s || v == t ? static_cast<uint32_t>(max_paths) : 1;
+        add_arc(2 * v, 2 * v + 1, capacity, 0.0);
+        for (const auto& link : state->topology_chunk(v).adjacency[v & (CHUNK_NODES - 1)]) {
+            add_arc(2 * v + 1, 2 * link.to, 1, link.latency + step_cost(*state, v, link.to));
+        }
+    }
+    
+    // Ardışık en kısa artırma yolları; potansiyellerle indirgenmiş maliyet negatif olmaz
+    const double inf = std::numeric_limits<double>::infinity();
+    const uint32_t from = 2 * s + 1;
+    const uint32_t sink = 2 * t;
+    std::vector<double> potential(vertices, 0.0);
+    std::vector<double> distance(vertices);
+    std::vector<uint32_t> via(vertices);
+    size_t found = 0;
+    using HeapItem = std::pair<double, uint32_t>;
+    
+    while (found < max_paths) {
+        std::fill(distance.begin(), distance.end(), inf);
+        std::fill(via.begin(), via.end(), NO_NODE);
+        std::priority_queue<HeapItem, std::vector<HeapItem>, std::greater<HeapItem>> heap;
+        distance[from] = 0.0;
+        heap.emplace(0.0, from);
+        while (!heap.empty()) {
+            auto [d, u] = heap.top();
+            heap.pop();
+            if (d > distance[u]) {
+                continue;
+            }
+            for (uint32_t a : out[u]) {
+                const FlowArc& arc = arcs[a];
+                if (arc.capacity == 0) {
+                    continue;
+                }
+                double reduced = std::max(0.0, arc.cost + potential[u] - potential[arc.to]);
+                if (d + reduced < distance[arc.to]) {
+                    distance[arc.to] = d + reduced;
+                    via[arc.to] = a;
+                    heap.emplace(distance[arc.to], arc.to);
+                }
+            }
+        }
+        if (distance[sink] == inf) {
+            break;
+        }
+        
+        for (uint32_t v = 0; v < vertices; ++v) {
+            if (distance[v] != inf) {
+                potential[v] += distance[v];
+            }
+        }
+        for (uint32_t v = sink; v != from; v = arcs[via[v] ^ 1].to) {
+            --arcs[via[v]].capacity;
+            ++arcs[via[v] ^ 1].capacity;
+        }
+        ++found;
+    }
+    
+    // Akışı yollara ayır: çıkış(u) -> giriş(v) yaylarında akış kalan kapasitenin eksiği
+    std::vector<std::pair<double, std::vector<uint32_t>>> paths;
+    for (size_t p = 0; p < found; ++p) {
+        std::vector<uint32_t> hops{s};
+        double cost = 0.0;
+        uint32_t u = s;
+        while (u != t && hops.size() <= state->node_count) {
+            uint32_t next = NO_NODE;
+            for (uint32_t a : out[2 * u + 1]) {
+                // Çift indeksli yaylar ileri yaydır; ters yayında kapasite = akış
+                if ((a & 1) == 0 && arcs[a ^ 1].capacity > 0) {
+                    --arcs[a ^ 1].capacity;
+                    next = arcs[a].to / 2;
+                    cost += arcs[a].cost;
+                    break;
+                }
+            }
+            if (next == NO_NODE) {
+                break;
+            }
+            hops.push_back(next);
+            u = next;
+        }
+        if (u == t) {
+            paths.emplace_back(cost, std::move(hops));
+        }
+    }
+    std::sort(paths.begin(), paths.end());
+    
+    std::vector<std::vector<PublicKey>> routes;
+    for (const auto& path : paths) {
+        routes.push_back(to_keys(*state, path.second));
+    }
+    return routes;
+}
+
+void AIRouter::learn(const std::vector<PublicKey>& path, double reward) {
+    std::lock_guard<std::mutex> lock(write_mutex);
+    learn_path(path, reward);
+}
+
+void AIRouter::learn(const std::vector<PathFeedback>& feedback) {
+    std::lock_guard<std::mutex> lock(write_mutex);
+    for (const auto& entry : feedback) {
+        learn_path(entry.path, entry.reward);
+    }
+}
+
+void AIRouter::learn_path(const std::vector<PublicKey>& path, double reward) {
+    // Q-learning update
+    // Q(s,a) = Q(s,a) + α * (reward + γ * max(Q(s',a')) - Q(s,a))
+    
+    if (path.size() < 2) {
+        return; // Öğrenilecek kenar yok
+    }
+    
+    std::vector<uint32_t> hops(path.size());
+    for (size_t i = 0; i < path.size(); ++i) {
+        hops[i] = intern(path[i]);
+    }
+    
+    for (size_t i = 0; i < hops.size() - 1; ++i) {
+        EdgeState& edge = writable_edge(edge_key(hops[i], hops[i + 1]));
+        double old_q = edge.learned ? edge.q : 0.0;
+        
+        // Next state max Q
+        double max_next_q = 0.0;
+        if (i + 2 < hops.size()) {
+            const EdgeState* next = draft->edge(edge_key(hops[i + 1], hops[i + 2]));
+            if (next && next->learned) {
+                max_next_q = next->q;
+            }
+        }
+        
+        if (!edge.learned) {
+            edge.learned = true;
+            ++draft->q_entries;
+        }
+        edge.q = old_q + learning_rate * (reward + discount_factor * max_next_q - old_q);
+        stamp_change(edge.stamp, q_discount(edge.q));
+        note_hierarchy_edge(hops[i], hops[i + 1]);
+    }
+    dirty.store(true, std::memory_order_release);
+}
+
+double AIRouter::q_value(const PublicKey& from, const PublicKey& to) {
+    auto state = view();
+    uint32_t u, v;
+    if (!state->lookup(from, u) || !state->lookup(to, v)) {
+        return 0.0;
+    }
+    const EdgeState* edge = state->edge(edge_key(u, v));
+    return edge && edge->learned ? edge->q : 0.0;
+}
+
+// ============================================================================
+// AIRouter CONTRACTION HIERARCHY İMPLEMENTASYONU
+// ============================================================================
+
+namespace {
+constexpr size_t DISSECTION_LEAF = 32;
+
+// Sorgu başına O(V) sıfırlamayı önlemek için thread başına tampon; yalnızca
+// dokunulan (eliminasyon ağacı yolundaki) girdiler geri sıfırlanır
+struct HierarchyScratch {
+    std::vector<double> forward;
+    std::vector<double> backward;
+    std::vector<uint32_t> forward_pred;
+    std::vector<uint32_t> backward_pred;
+    std::vector<uint32_t> source_path;
+    std::vector<uint32_t> dest_path;
+    std::vector<std::pair<uint32_t, uint32_t>> unpack;
+};
+
+HierarchyScratch& hierarchy_scratch(size_t nodes) {
+    thread_local HierarchyScratch scratch;
+    if (scratch.forward.size() < nodes) {
+        const double inf = std::numeric_limits<double>::infinity();
+        scratch.forward.assign(nodes, inf);
+        scratch.backward.assign(nodes, inf);
+        scratch.forward_pred.assign(nodes, NO_NODE);
+        scratch.backward_pred.assign(nodes, NO_NODE);
+    }
+    return scratch;
+}
+}
+
+uint32_t AIRouter::HierarchyTopology::find_arc(uint32_t low, uint32_t high) const {
+    auto first = up_head.begin() + up_begin[low];
+    auto last = up_head.begin() + up_begin[low + 1];
+    auto it = std::lower_bound(first, last, high);
+    return it == last || *it != high ? UINT32_MAX : static_cast<uint32_t>(it - up_head.begin());
+}
+
+std::shared_ptr<AIRouter::HierarchyTopology> AIRouter::build_hierarchy_topology(const RouterState& state, size_t max_arcs) {
+    const uint32_t n = static_cast<uint32_t>(state.node_count);
+    auto neighbors = [&state](uint32_t v) -> const std::vector<Link>& {
+        return state.topology_chunk(v).adjacency[v & (CHUNK_NODES - 1)];
+    };
+    
+    // 1) Nested dissection: BFS seviye yapısından ayırıcı. Ayırıcı kendi
+    // parçasındaki her düğümden yüksek sıra alır; iki yarı ayrı işlenir.
+    auto topology = std::make_shared<HierarchyTopology>();
+    std::vector<uint32_t>& rank = topology->rank;
+    rank.assign(n, NO_NODE);
+    uint32_t next = n;
+    
+    std::vector<uint32_t> member(n, 0);
+    std::vector<uint32_t> seen(n, 0);
+    std::vector<uint32_t> level(n, 0);
+    uint32_t member_tag = 0;
+    uint32_t seen_tag = 0;
+    std::vector<uint32_t> queue;
+    
+    auto bfs = [&](uint32_t root) {
+        ++seen_tag;
+        queue.clear();
+        queue.push_back(root);
+        seen[root] = seen_tag;
+        level[root] = 0;
+        for (size_t head = 0; head < queue.size(); ++head) {
+            uint32_t u = queue[head];
+            for (const auto& link : neighbors(u)) {
+                if (member[link.to] == member_tag && seen[link.to] != seen_tag) {
+                    seen[link.to] = seen_tag;
+                    level[link.to] = level[u] + 1;
+                    queue.push_back(link.to);
+                }
+            }
+        }
+    };
+    
+    std::vector<std::vector<uint32_t>> parts;
+    parts.emplace_back(n);
+    for (uint32_t v = 0; v < n; ++v) {
+        parts.back()[v] = v;
+    }
+    
+    while (!parts.empty()) {
+        std::vector<uint32_t> part = std::move(parts.back());
+        parts.pop_back();
+        if (part.size() <= DISSECTION_LEAF) {
+            for (uint32_t v : part) {
+                rank[v] = --next;
+            }
+            continue;
+        }
+        
+        ++member_tag;
+        for (uint32_t v : part) {
+            member[v] = member_tag;
+        }
+        
+        // Yaklaşık çevresel kök: bir BFS'in son düğümü
+        bfs(part[0]);
+        bfs(queue.back());
+        if (queue.size() < part.size()) {
+            // Bağlı değil: bileşen ve kalanı ayırıcısız bölünür
+            std::vector<uint32_t> rest;
+            for (uint32_t v : part) {
+                if (seen[v] != seen_tag) {
+                    rest.push_back(v);
+                }
+            }
+            parts.push_back(std::move(rest));
+            parts.push_back(queue);
+            continue;
+        }
+        
+        // Kümülatif boyutun ortadaki yarısında en dar seviye
+        uint32_t levels = level[queue.back()] + 1;
+        std::vector<uint32_t> width(levels, 0);
+        for (uint32_t v : queue) {
+            ++width[level[v]];
+        }
+        uint32_t cut = levels;
+        size_t before = 0;
+        for (uint32_t l = 0; l < levels; ++l) {
+            if (l > 0 && l + 1 < levels && before >= part.size() / 4 && before + width[l] <= part.size() * 3 / 4 + 1 &&
+                (cut == levels || width[l] < width[cut])) {
+                cut = l;
+            }
+            before += width[l];
+        }
+        if (cut == levels) {
+            // Ayrılamayacak kadar yoğun: tek blok
+            for (uint32_t v : part) {
+                rank[v] = --next;
+            }
+            continue;
+        }
+        
+        std::vector<uint32_t> lower, upper;
+        for (uint32_t v : queue) {
+            if (level[v] == cut) {
+                rank[v] = --next;
+            } else if (level[v] < cut) {
+                lower.push_back(v);
+            } else {
+                upper.push_back(v);
+            }
+        }
+        parts.push_back(std::move(lower));
+        parts.push_back(std::move(upper));
+    }
+    
+    topology->order.assign(n, 0);
+    for (uint32_t v = 0; v < n; ++v) {
+        topology->order[rank[v]] = v;
+    }
+    
+    // 2) Sembolik eliminasyon: düğümün üst komşuları ebeveyninde kliğe tamamlanır
+    std::vector<std::vector<uint32_t>> up(n);
+    for (uint32_t v = 0; v < n; ++v) {
+        for (const auto& link : neighbors(v)) {
+            if (rank[link.to] > rank[v]) {
+                up[rank[v]].push_back(rank[link.to]);
+            }
+        }
+    }
+    size_t arcs = 0;
+    topology->triangles = 0;
+    for (uint32_t r = 0; r < n; ++r) {
+        auto& list = up[r];
+        std::sort(list.begin(), list.end());
+        list.erase(std::unique(list.begin(), list.end()), list.end());
+        arcs += list.size();
+        topology->triangles += static_cast<uint64_t>(list.size()) * (list.size() - (list.empty() ? 0 : 1)) / 2;
+        if (arcs > max_arcs) {
+            return nullptr;
+        }
+        if (!list.empty()) {
+            auto& parent = up[list[0]];
+            parent.insert(parent.end(), list.begin() + 1, list.end());
+        }
+    }
+    
+    topology->up_begin.assign(n + 1, 0);
+    topology->up_head.reserve(arcs);
+    std::vector<uint32_t> lower_count(n + 1, 0);
+    for (uint32_t r = 0; r < n; ++r) {
+        topology->up_begin[r] = static_cast<uint32_t>(topology->up_head.size());
+        for (uint32_t h : up[r]) {
+            topology->up_head.push_back(h);
+            ++lower_count[h + 1];
+        }
+        std::vector<uint32_t>().swap(up[r]);
+    }
+    topology->up_begin[n] = static_cast<uint32_t>(topology->up_head.size());
+    
+    // Alt komşu listeleri: kuyruk sırasıyla gezildiği için artan
+    topology->down_begin.assign(n + 1, 0);
+    for (uint32_t r = 0; r < n; ++r) {
+        topology->down_begin[r + 1] = topology->down_begin[r] + lower_count[r + 1];
+    }
+    topology->down_tail.resize(arcs);
+    topology->down_arc.resize(arcs);
+    std::vector<uint32_t> fill(topology->down_begin.begin(), topology->down_begin.end() - 1);
+    for (uint32_t r = 0; r < n; ++r) {
+        for (uint32_t a = topology->up_begin[r]; a < topology->up_begin[r + 1]; ++a) {
+            uint32_t slot = fill[topology->up_head[a]]++;
+            topology->down_tail[slot] = r;
+            topology->down_arc[slot] = a;
+        }
+    }
+    
+    // Eliminasyon ağacı derinliği: sorgu başına yürünen en uzun yol
+    std::vector<uint32_t> depth(n, 1);
+    topology->depth = 0;
+    for (uint32_t r = n; r-- > 0;) {
+        uint32_t parent = topology->parent(r);
+        if (parent != UINT32_MAX) {
+            depth[r] = depth[parent] + 1;
+        }
+        topology->depth = std::max(topology->depth, depth[r]);
+    }
+    return topology;
+}
+
+double AIRouter::input_weight(const RouterState& state, const HierarchyTopology& topology,
+                              uint32_t low, uint32_t high, bool upward) {
+    // Bağlantı yoksa yalnızca dolgu yayı: sonsuz
+    return edge_weight(state, topology.order[upward ? low : high], topology.order[upward ? high : low]);
+}
+
+void AIRouter::customize(const RouterState& state, Hierarchy& hierarchy) {
+    const HierarchyTopology& topology = *hierarchy.topology;
+    const uint32_t n = topology.nodes();
+    const double inf = std::numeric_limits<double>::infinity();
+    
+    std::vector<ArcBlock*> blocks;
+    hierarchy.blocks.clear();
+    for (uint32_t b = 0; b * ARC_BLOCK < topology.arcs(); ++b) {
+        auto block = std::make_shared<ArcBlock>();
+        block->up.fill(inf);
+        block->down.fill(inf);
+        block->up_via.fill(NO_NODE);
+        block->down_via.fill(NO_NODE);
+        blocks.push_back(block.get());
+        hierarchy.blocks.push_back(std::move(block));
+    }
+    auto up = [&blocks](uint32_t arc) -> double& { return blocks[arc >> ARC_BLOCK_BITS]->up[arc & (ARC_BLOCK - 1)]; };
+    auto down = [&blocks](uint32_t arc) -> double& { return blocks[arc >> ARC_BLOCK_BITS]->down[arc & (ARC_BLOCK - 1)]; };
+    
+    // Girdi ağırlıkları: orijinal bağlantılar
+    for (uint32_t v = 0; v < n; ++v) {
+        uint32_t rv = topology.rank[v];
+        for (const auto& link : state.topology_chunk(v).adjacency[v & (CHUNK_NODES - 1)]) {
+            uint32_t ru = topology.rank[link.to];
+            double weight = link.latency + step_cost(state, v, link.to);
+            if (rv < ru) {
+                double& slot = up(topology.find_arc(rv, ru));
+                slot = std::min(slot, weight);
+            } else {
+                double& slot = down(topology.find_arc(ru, rv));
+                slot = std::min(slot, weight);
+            }
+        }
+    }
+    
+    // Alt üçgenler: x'in her üst komşu çifti (u < v) için u -> x -> v ve v -> x -> u
+    for (uint32_t x = 0; x < n; ++x) {
+        uint32_t first = topology.up_begin[x];
+        uint32_t last = topology.up_begin[x + 1];
+        for (uint32_t i = first; i < last; ++i) {
+            uint32_t u = topology.up_head[i];
+            auto search = topology.up_head.begin() + topology.up_begin[u];
+            auto search_end = topology.up_head.begin() + topology.up_begin[u + 1];
+            for (uint32_t j = i + 1; j < last; ++j) {
+                uint32_t v = topology.up_head[j];
+                search = std::lower_bound(search, search_end, v);
+                uint32_t uv = static_cast<uint32_t>(search - topology.up_head.begin());
+                
+                double forward = down(i) + up(j);
+                if (forward < up(uv)) {
+                    up(uv) = forward;
+                    blocks[uv >> ARC_BLOCK_BITS]->up_via[uv & (ARC_BLOCK - 1)] = x;
+                }
+                double backward = down(j) + up(i);
+                if (backward < down(uv)) {
+                    down(uv) = backward;
+                    blocks[uv >> ARC_BLOCK_BITS]->down_via[uv & (ARC_BLOCK - 1)] = x;
+                }
+            }
+        }
     }
-    distances[source] = 0.0;
+}
+
+size_t AIRouter::recustomize(const RouterState& state, Hierarchy& hierarchy) {
+    const HierarchyTopology& topology = *hierarchy.topology;
+    const uint32_t n = topology.nodes();
+    
+    // Yay bayrakları: kuyrukta, tam yeniden hesap gerekli, değeri değişti
+    constexpr uint8_t QUEUED = 1;
+    constexpr uint8_t FULL = 2;
+    constexpr uint8_t CHANGED = 4;
+    using Item = std::pair<uint32_t, uint32_t>;     // (alt uç sırası, yay)
+    std::priority_queue<Item, std::vector<Item>, std::greater<Item>> queue;
+    
+    // Yoğun bayrak dizisi: dokunulan yaylar sonda sıfırlanır, tahsis bir kez
+    std::vector<uint8_t>& flags = arc_flags;
+    if (flags.size() != topology.arcs()) {
+        flags.assign(topology.arcs(), 0);
+    }
+    std::vector<uint32_t> touched;
+    auto mark = [&](uint32_t low, uint32_t arc, uint8_t bits) {
+        uint8_t& slot = flags[arc];
+        if (!(slot & QUEUED)) {
+            queue.emplace(low, arc);
+            touched.push_back(arc);
+        }
+        slot |= QUEUED | bits;
+    };
+    auto clear_flags = [&]() {
+        for (uint32_t arc : touched) {
+            flags[arc] = 0;
+        }
+    };
+    auto seed = [&](uint32_t a, uint32_t b) {
+        uint32_t arc = topology.find_arc(std::min(a, b), std::max(a, b));
+        if (arc != UINT32_MAX) {
+            mark(std::min(a, b), arc, FULL);
+        }
+    };
     
-    while (!unvisited.empty()) {
-        // Find node with minimum distance
-        auto min_it = std::min_element(unvisited.begin(), unvisited.end(),
-            [&distances](const PublicKey& a, const PublicKey& b) {
-                return distances[a] < distances[b];
-            });
+    // Değişen girdiler: düğüm maliyeti o düğüme gelen her kenarı etkiler
+    for (uint32_t v : hierarchy_nodes) {
+        if (v >= n) {
+            continue;
+        }
+        for (const auto& link : state.topology_chunk(v).adjacency[v & (CHUNK_NODES - 1)]) {
+            seed(topology.rank[link.to], topology.rank[v]);
+        }
+    }
+    for (uint64_t key : hierarchy_edges) {
+        uint32_t from = static_cast<uint32_t>(key >> 32);
+        uint32_t to = static_cast<uint32_t>(key);
+        if (from < n && to < n) {
+            seed(topology.rank[from], topology.rank[to]);
+        }
+    }
+    hierarchy_nodes.clear();
+    hierarchy_edges.clear();
+    
+    // Yalnızca değişen bloklar kopyalanır; gerisi yayınlanmış görüntüyle ortak
+    std::vector<uint8_t> owned(hierarchy.blocks.size(), 0);
+    auto writable = [&](uint32_t arc) -> ArcBlock& {
+        uint32_t b = arc >> ARC_BLOCK_BITS;
+        if (!owned[b]) {
+            hierarchy.blocks[b] = std::make_shared<ArcBlock>(*hierarchy.blocks[b]);
+            owned[b] = 1;
+        }
+        return const_cast<ArcBlock&>(*hierarchy.blocks[b]);
+    };
+    
+    // Tam yeniden hesap: girdi + tüm alt üçgenler (ortak alt komşular z)
+    uint64_t work = 0;
+    auto recompute = [&](uint32_t low, uint32_t arc) {
+        uint32_t high = topology.up_head[arc];
+        double up = input_weight(state, topology, low, high, true);
+        double down = input_weight(state, topology, low, high, false);
+        uint32_t up_via = NO_NODE;
+        uint32_t down_via = NO_NODE;
         
-        if (min_it == unvisited.end() || distances[*min_it] == std::numeric_limits<double>::infinity()) {
-            break;
+        uint32_t i = topology.down_begin[low];
+        uint32_t i_end = topology.down_begin[low + 1];
+        uint32_t j = topology.down_begin[high];
+        uint32_t j_end = topology.down_begin[high + 1];
+        work += (i_end - i) + (j_end - j);
+        while (i < i_end && j < j_end) {
+            uint32_t zi = topology.down_tail[i];
+            uint32_t zj = topology.down_tail[j];
+            if (zi < zj) {
+                ++i;
+            } else if (zj < zi) {
+                ++j;
+            } else {
+                uint32_t zl = topology.down_arc[i];
+                uint32_t zh = topology.down_arc[j];
+                double forward = hierarchy.down(zl) + hierarchy.up(zh);
+                if (forward < up) {
+                    up = forward;
+                    up_via = zi;
+                }
+                double backward = hierarchy.down(zh) + hierarchy.up(zl);
+                if (backward < down) {
+                    down = backward;
+                    down_via = zi;
+                }
+                ++i;
+                ++j;
+            }
         }
         
-        PublicKey current = *min_it;
-        unvisited.erase(min_it);
+        bool changed = up != hierarchy.up(arc) || down != hierarchy.down(arc);
+        if (changed || up_via != hierarchy.up_via(arc) || down_via != hierarchy.down_via(arc)) {
+            ArcBlock& block = writable(arc);
+            uint32_t slot = arc & (ARC_BLOCK - 1);
+            block.up[slot] = up;
+            block.down[slot] = down;
+            block.up_via[slot] = up_via;
+            block.down_via[slot] = down_via;
+        }
+        return changed;
+    };
+    
+    // Üçgen (r; u < v): u -> r -> v ve v -> r -> u, (u, v) yayına. Düşüş
+    // hemen uygulanır; argmin olan üçgen kötüleştiyse yay tam hesaba gider.
+    auto relax = [&](uint32_t r, double up, double down, uint32_t low, uint32_t dependent) {
+        uint8_t bits = 0;
+        if (up < hierarchy.up(dependent) || down < hierarchy.down(dependent)) {
+            ArcBlock& block = writable(dependent);
+            uint32_t slot = dependent & (ARC_BLOCK - 1);
+            if (up < block.up[slot]) {
+                block.up[slot] = up;
+                block.up_via[slot] = r;
+            }
+            if (down < block.down[slot]) {
+                block.down[slot] = down;
+                block.down_via[slot] = r;
+            }
+            bits |= CHANGED;
+        }
+        if ((hierarchy.up_via(dependent) == r && up > hierarchy.up(dependent)) ||
+            (hierarchy.down_via(dependent) == r && down > hierarchy.down(dependent))) {
+            bits |= FULL;
+        }
+        if (bits) {
+            mark(low, dependent, bits);
+        }
+    };
+    
+    // Alt uç sırasıyla gruplar halinde: aynı alt uçlu yaylar birbirine bağlı
+    // değil, daha alttakiler zaten kesin. r'nin üst komşu çiftlerinden en az
+    // biri değişmiş olanlar gezilir (çift başına bir kez); (u, v) yayı
+    // customize'daki gibi u'nun listesinde ilerleyen aramayla bulunur.
+    std::vector<uint32_t> group;
+    std::vector<uint32_t> changed;
+    std::vector<double> row_up;
+    std::vector<double> row_down;
+    while (!queue.empty()) {
+        // Değişiklik hiyerarşinin tepesine yayıldıysa tam özelleştirme daha ucuz
+        // (kısmi üçgen tam üçgen kadar sürer; kuyruk ve blok kopyaları için pay)
+        if (work > topology.triangles / 2) {
+            clear_flags();
+            customize(state, hierarchy);
+            ++hierarchy_info.full_fallbacks;
+            return topology.arcs();
+        }
         
-        if (current == dest) {
-            break;
+        uint32_t r = queue.top().first;
+        group.clear();
+        while (!queue.empty() && queue.top().first == r) {
+            group.push_back(queue.top().second);
+            queue.pop();
         }
         
-        // Check neighbors
-        for (const auto& neighbor : available_nodes) {
-            if (std::find(unvisited.begin(), unvisited.end(), neighbor) == unvisited.end()) {
-                continue;
+        changed.clear();
+        for (uint32_t arc : group) {
+            uint8_t& bits = flags[arc];
+            if (bits & FULL) {
+                if (recompute(r, arc)) {
+                    bits |= CHANGED;
+                }
             }
-            
-            // Cost calculation with AI metrics
-            double cost = 1.0;
-            
-            if (node_metrics.find(neighbor) != node_metrics.end()) {
-                const auto& metrics = node_metrics[neighbor];
-                
-                // Multi-factor cost
-                cost = metrics.avg_latency * 0.4 +
-                       metrics.packet_loss * 100.0 * 0.3 +
-                       (1.0 / metrics.bandwidth) * 0.2 +
-                       (1.0 - metrics.node_reputation) * 0.1;
+            if (bits & CHANGED) {
+                changed.push_back(arc);
             }
-            
-            // Q-learning enhancement
-            std::string state_key = hash_to_string(current) + "_" + hash_to_string(neighbor);
-            if (q_table.find(state_key) != q_table.end()) {
-                cost *= (1.0 - q_table[state_key] * 0.2); // Q-value reduces cost
+        }
+        if (changed.empty()) {
+            continue;
+        }
+        std::sort(changed.begin(), changed.end());
+        
+        // r'nin yay ağırlıkları bu adımda sabit: bir kez okunur
+        uint32_t first = topology.up_begin[r];
+        uint32_t last = topology.up_begin[r + 1];
+        row_up.clear();
+        row_down.clear();
+        for (uint32_t a = first; a < last; ++a) {
+            row_up.push_back(hierarchy.up(a));
+            row_down.push_back(hierarchy.down(a));
+        }
+        auto next_changed = changed.begin();
+        for (uint32_t i = first; i < last; ++i) {
+            bool i_changed = next_changed != changed.end() && *next_changed == i;
+            if (i_changed) {
+                ++next_changed;
             }
-            
-            double alt = distances[current] + cost;
-            
-            if (alt < distances[neighbor]) {
-                distances[neighbor] = alt;
-                previous[neighbor] = current;
+            if (!i_changed && next_changed == changed.end()) {
+                break;      // kalan çiftlerin hiçbiri değişmedi
+            }
+            uint32_t u = topology.up_head[i];
+            auto search = topology.up_head.begin() + topology.up_begin[u];
+            auto search_end = topology.up_head.begin() + topology.up_begin[u + 1];
+            auto pair = [&](uint32_t j) {
+                uint32_t v = topology.up_head[j];
+                search = std::lower_bound(search, search_end, v);
+                ++work;
+                relax(r, row_down[i - first] + row_up[j - first], row_down[j - first] + row_up[i - first], u,
+                      static_cast<uint32_t>(search - topology.up_head.begin()));
+            };
+            if (i_changed) {
+                for (uint32_t j = i + 1; j < last; ++j) {
+                    pair(j);
+                }
+            } else {
+                for (auto it = next_changed; it != changed.end(); ++it) {
+                    pair(*it);
+                }
             }
         }
     }
     
-    // Reconstruct path
-    std::vector<PublicKey> path;
-    PublicKey current = dest;
+    clear_flags();
+    return touched.size();
+}
+
+bool AIRouter::hierarchy_route(const RouterState& state, uint32_t source, uint32_t dest, std::vector<uint32_t>& hops) {
+    const Hierarchy& hierarchy = *state.hierarchy;
+    const HierarchyTopology& topology = *hierarchy.topology;
+    const uint32_t n = topology.nodes();
+    if (source >= n || dest >= n) {
+        return false;   // hiyerarşiden sonra eklenen düğüm: Dijkstra
+    }
+    
+    const double inf = std::numeric_limits<double>::infinity();
+    HierarchyScratch& scratch = hierarchy_scratch(n);
+    uint32_t s = topology.rank[source];
+    uint32_t t = topology.rank[dest];
+    
+    // İki uçtan köke: üst komşular her zaman ata olduğundan yalnızca yol gezilir
+    scratch.source_path.clear();
+    scratch.dest_path.clear();
+    for (uint32_t x = s; x != UINT32_MAX; x = topology.parent(x)) {
+        scratch.source_path.push_back(x);
+    }
+    for (uint32_t x = t; x != UINT32_MAX; x = topology.parent(x)) {
+        scratch.dest_path.push_back(x);
+    }
+    
+    // Yollar en küçük ortak atadan köke kadar ortaktır
+    size_t common_s = scratch.source_path.size();
+    size_t common_t = scratch.dest_path.size();
+    while (common_s > 0 && common_t > 0 &&
+           scratch.source_path[common_s - 1] == scratch.dest_path[common_t - 1]) {
+        --common_s;
+        --common_t;
+    }
+    
+    auto relax = [&hierarchy, &topology](uint32_t x, bool upward, std::vector<double>& dist, std::vector<uint32_t>& pred) {
+        double d = dist[x];
+        for (uint32_t a = topology.up_begin[x]; a < topology.up_begin[x + 1]; ++a) {
+            uint32_t y = topology.up_head[a];
+            double alt = d + (upward ? hierarchy.up(a) : hierarchy.down(a));
+            if (alt < dist[y]) {
+                dist[y] = alt;
+                pred[y] = x;
+            }
+        }
+    };
     
-    while (current != source) {
-        path.push_back(current);
-        if (previous.find(current) == previous.end()) {
-            return {}; // No path found
+    scratch.forward[s] = 0.0;
+    scratch.backward[t] = 0.0;
+    for (size_t i = 0; i < common_s; ++i) {
+        if (scratch.forward[scratch.source_path[i]] != inf) {
+            relax(scratch.source_path[i], true, scratch.forward, scratch.forward_pred);
+        }
+    }
+    for (size_t i = 0; i < common_t; ++i) {
+        if (scratch.backward[scratch.dest_path[i]] != inf) {
+            relax(scratch.dest_path[i], false, scratch.backward, scratch.backward_pred);
         }
-        current = previous[current];
     }
-    path.push_back(source);
     
-    std::reverse(path.begin(), path.end());
-    return path;
+    // Ortak kısımda en iyi toplamdan uzun kalan taraf genişletilmez (ağırlıklar negatif değil)
+    double best = inf;
+    uint32_t meet = UINT32_MAX;
+    for (size_t i = common_s; i < scratch.source_path.size(); ++i) {
+        uint32_t x = scratch.source_path[i];
+        double total = scratch.forward[x] + scratch.backward[x];
+        if (total < best) {
+            best = total;
+            meet = x;
+        }
+        if (scratch.forward[x] < best) {
+            relax(x, true, scratch.forward, scratch.forward_pred);
+        }
+        if (scratch.backward[x] < best) {
+            relax(x, false, scratch.backward, scratch.backward_pred);
+        }
+    }
+    
+    // Hiyerarşi yolu: s ... meet ... t (sıra uzayında)
+    std::vector<uint32_t> ranks;
+    if (meet != UINT32_MAX) {
+        for (uint32_t x = meet; x != s; x = scratch.forward_pred[x]) {
+            ranks.push_back(x);
+        }
+        ranks.push_back(s);
+        std::reverse(ranks.begin(), ranks.end());
+        for (uint32_t x = meet; x != t; ) {
+            x = scratch.backward_pred[x];
+            ranks.push_back(x);
+        }
+    }
+    
+    for (uint32_t x : scratch.source_path) {
+        scratch.forward[x] = inf;
+        scratch.forward_pred[x] = NO_NODE;
+    }
+    for (uint32_t x : scratch.dest_path) {
+        scratch.backward[x] = inf;
+        scratch.backward_pred[x] = NO_NODE;
+    }
+    
+    hops.clear();
+    if (ranks.empty()) {
+        return true; // No path found
+    }
+    
+    // Kısayolları ortadaki düğümle özyinelemesiz aç
+    hops.push_back(source);
+    for (size_t k = 1; k < ranks.size(); ++k) {
+        scratch.unpack.clear();
+        scratch.unpack.emplace_back(ranks[k - 1], ranks[k]);
+        while (!scratch.unpack.empty()) {
+            auto [a, b] = scratch.unpack.back();
+            scratch.unpack.pop_back();
+            uint32_t via = a < b ? hierarchy.up_via(topology.find_arc(a, b))
+                                 : hierarchy.down_via(topology.find_arc(b, a));
+            if (via == NO_NODE) {
+                hops.push_back(topology.order[b]);
+            } else {
+                scratch.unpack.emplace_back(via, b);
+                scratch.unpack.emplace_back(a, via);
+            }
+        }
+    }
+    return true;
 }
 
-std::vector<PublicKey> AIRouter::find_optimal_route(
-    const Transaction& tx,
-    const std::vector<PublicKey>& network_nodes) {
+bool AIRouter::prepare_hierarchy(size_t max_arcs_per_link) {
+    std::lock_guard<std::mutex> lock(write_mutex);
+    refresh_costs();    // özelleştirme taslaktaki güncel maliyetleri okur
+    
+    auto start = std::chrono::steady_clock::now();
+    auto topology = build_hierarchy_topology(*draft, max_arcs_per_link * std::max<size_t>(1, draft->links));
+    double order_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    
+    hierarchy_info = HierarchyStats();
+    hierarchy_info.order_ms = order_ms;
+    hierarchy_nodes.clear();
+    hierarchy_edges.clear();
+    if (!topology) {
+        draft->hierarchy.reset();
+        publish_locked();
+        return false;
+    }
+    
+    start = std::chrono::steady_clock::now();
+    auto hierarchy = std::make_shared<Hierarchy>();
+    hierarchy->topology = topology;
+    customize(*draft, *hierarchy);
+    hierarchy_info.customize_ms =
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    
+    hierarchy_info.active = true;
+    hierarchy_info.nodes = topology->nodes();
+    hierarchy_info.links = draft->links;
+    hierarchy_info.arcs = topology->arcs();
+    hierarchy_info.tree_depth = topology->depth;
+    draft->hierarchy = hierarchy;
+    publish_locked();
+    return true;
+}
+
+void AIRouter::drop_hierarchy() {
+    std::lock_guard<std::mutex> lock(write_mutex);
+    draft->hierarchy.reset();
+    hierarchy_nodes.clear();
+    hierarchy_edges.clear();
+    hierarchy_info.active = false;
+    publish_locked();
+}
+
+AIRouter::HierarchyStats AIRouter::hierarchy_stats() {
+    std::lock_guard<std::mutex> lock(write_mutex);
+    return hierarchy_info;
+}
+
+// ============================================================================
+// JSON-RPC İSTEMCİSİ İMPLEMENTASYONU
+// ============================================================================
+
+namespace {
+bool send_all(int fd, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        sent += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// Tampondan ya da soketten tek bir HTTP yanıtı; fazla okunan baytlar
+// (pipelining: sonraki yanıtlar) tamponda kalır
+bool read_http_response(int fd, std::string& buffer, int& status, std::string& body, bool& close_after) {
+    size_t header_end;
+    auto fill = [&]() {
+        char chunk[16384];
+        ssize_t n;
+        do {
+            n = ::recv(fd, chunk, sizeof(chunk), 0);
+        } while (n < 0 && errno == EINTR);
+        if (n <= 0) {
+            return false;
+        }
+        buffer.append(chunk, static_cast<size_t>(n));
+        return true;
+    };
+    while ((header_end = buffer.find("\r\n\r\n")) == std::string::npos) {
+        if (buffer.size() > 65536 || !fill()) {
+            return false;
+        }
+    }
+    
+    std::string head = buffer.substr(0, header_end);
+    std::transform(head.begin(), head.end(), head.begin(),
+                   [](char c) { return static_cast<char>(std::tolower(static_cast<unsigned char>(c))); });
+    if (head.compare(0, 5, "http/") != 0 || head.find(' ') == std::string::npos) {
+        return false;
+    }
+    status = std::atoi(head.c_str() + head.find(' ') + 1);
+    size_t length_at = head.find("\r\ncontent-length:");
+    if (length_at == std::string::npos) {
+        return false;       // chunked gövde desteklenmez
+    }
+    size_t length = std::strtoull(head.c_str() + length_at + 17, nullptr, 10);
+    close_after = head.find("\r\nconnection: close") != std::string::npos;
     
-    PublicKey source, dest;
-    std::memcpy(source.data(), tx.from.data(), std::min(source.size(), tx.from.size()));
-    std::memcpy(dest.data(), tx.to.data(), std::min(dest.size(), tx.to.size()));
+    size_t total = header_end + 4 + length;
+    while (buffer.size() < total) {
+        if (!fill()) {
+            return false;
+        }
+    }
+    body = buffer.substr(header_end + 4, length);
+    buffer.erase(0, total);
+    return true;
+}
+}
+
+RpcClient::RpcClient(const std::string& endpoint, const RpcClientConfig& config)
+    : port(0), config(config), in_flight(0), stopping(false), next_id(1),
+      posts(0), connects(0), retries(0), failures(0), peak_in_flight(0) {
+    if (!parse_endpoint(endpoint, host, port)) {
+        throw std::invalid_argument("RPC uç noktası geçersiz: " + endpoint);
+    }
+    this->config.connections = std::max<size_t>(1, config.connections);
+    this->config.max_batch = std::max<size_t>(1, config.max_batch);
+    this->config.pipeline_depth = std::max<size_t>(1, config.pipeline_depth);
+    this->config.max_in_flight = std::max<size_t>(1, config.max_in_flight);
+    this->config.max_attempts = std::max<uint32_t>(1, config.max_attempts);
+    
+    for (size_t i = 0; i < this->config.connections; ++i) {
+        connections.emplace_back(&RpcClient::connection_loop, this);
+    }
+}
+
+RpcClient::~RpcClient() {
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        stopping = true;
+    }
+    queue_cv.notify_all();
+    for (auto& connection : connections) {
+        if (connection.joinable()) {
+            connection.join();
+        }
+    }
     
-    return calculate_optimal_path(source, dest, network_nodes);
+    // Hiç gönderilmemiş çağrılar
+    for (auto& pending : queue) {
+        RpcResponse response;
+        response.error = "client stopped";
+        pending.promise.set_value(std::move(response));
+    }
 }
 
-void AIRouter::learn(const std::vector<PublicKey>& path, double reward) {
-    // Q-learning update
-    // Q(s,a) = Q(s,a) + α * (reward + γ * max(Q(s',a')) - Q(s,a))
+bool RpcClient::parse_endpoint(const std::string& endpoint, std::string& host, uint16_t& port) {
+    const std::string scheme = "http://";
+    if (endpoint.compare(0, scheme.size(), scheme) != 0) {
+        return false;
+    }
+    std::string rest = endpoint.substr(scheme.size());
+    rest = rest.substr(0, rest.find('/'));
+    size_t colon = rest.rfind(':');
+    if (colon == std::string::npos || colon == 0 || colon + 1 == rest.size()) {
+        return false;
+    }
+    char* end = nullptr;
+    unsigned long value = std::strtoul(rest.c_str() + colon + 1, &end, 10);
+    if (*end != '\0' || value == 0 || value > 65535) {
+        return false;
+    }
+    host = rest.substr(0, colon);
+    port = static_cast<uint16_t>(value);
+    return true;
+}
+
+std::future<RpcResponse> RpcClient::call(const std::string& method, const std::string& params) {
+    PendingCall pending;
+    pending.method = method;
+    pending.params = params;
+    pending.attempts = 0;
+    std::future<RpcResponse> result = pending.promise.get_future();
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        pending.id = next_id++;
+        queue.push_back(std::move(pending));
+    }
+    queue_cv.notify_one();
+    return result;
+}
+
+RpcClientStats RpcClient::stats() {
+    RpcClientStats out;
+    out.posts = posts.load(std::memory_order_relaxed);
+    out.connects = connects.load(std::memory_order_relaxed);
+    out.retries = retries.load(std::memory_order_relaxed);
+    out.failures = failures.load(std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    out.calls = next_id - 1;
+    out.peak_in_flight = peak_in_flight;
+    return out;
+}
+
+int RpcClient::open_connection() {
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* list = nullptr;
+    if (::getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &list) != 0) {
+        return -1;
+    }
+    
+    int fd = -1;
+    for (addrinfo* ai = list; ai != nullptr && fd < 0; ai = ai->ai_next) {
+        fd = ::socket(ai->ai_family, ai->ai_socktype | SOCK_CLOEXEC, ai->ai_protocol);
+        if (fd < 0) {
+            continue;
+        }
+        // Linux'ta SO_SNDTIMEO connect() için de geçerlidir
+        timeval timeout{static_cast<time_t>(config.timeout_ms / 1000),
+                        static_cast<suseconds_t>(config.timeout_ms % 1000 * 1000)};
+        ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        ::setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        int one = 1;
+        ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        if (::connect(fd, ai->ai_addr, ai->ai_addrlen) != 0) {
+            ::close(fd);
+            fd = -1;
+        }
+    }
+    ::freeaddrinfo(list);
+    
+    if (fd >= 0) {
+        connects.fetch_add(1, std::memory_order_relaxed);
+    }
+    return fd;
+}
+
+void RpcClient::fail_batch(std::vector<PendingCall>& batch, const std::string& reason) {
+    std::vector<size_t> failed;
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        in_flight -= batch.size();
+        // Sıra korunarak kuyruğun başına
+        for (size_t i = batch.size(); i-- > 0;) {
+            if (++batch[i].attempts < config.max_attempts && !stopping) {
+                retries.fetch_add(1, std::memory_order_relaxed);
+                queue.push_front(std::move(batch[i]));
+            } else {
+                failed.push_back(i);
+            }
+        }
+    }
+    queue_cv.notify_all();
+    
+    for (size_t i : failed) {
+        failures.fetch_add(1, std::memory_order_relaxed);
+        RpcResponse response;
+        response.error = reason;
+        batch[i].promise.set_value(std::move(response));
+    }
+    batch.clear();
+}
+
+void RpcClient::connection_loop() {
+    int fd = -1;
+    std::string buffer;                                 // okunmuş, henüz ayrılmamış yanıt baytları
+    std::deque<std::vector<PendingCall>> outstanding;   // yazıldı, yanıtı sırayla bekleniyor
+    
+    auto drop_connection = [&](const std::string& reason) {
+        if (fd >= 0) {
+            ::close(fd);
+            fd = -1;
+        }
+        buffer.clear();
+        for (auto& batch : outstanding) {
+            fail_batch(batch, reason);
+        }
+        outstanding.clear();
+    };
     
-    for (size_t i = 0; i < path.size() - 1; ++i) {
-        std::string state_key = hash_to_string(path[i]) + "_" + hash_to_string(path[i + 1]);
+    while (true) {
+        std::vector<std::vector<PendingCall>> fresh;
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex);
+            auto ready = [&]() { return !stopping && !queue.empty() && in_flight < config.max_in_flight; };
+            if (outstanding.empty()) {
+                queue_cv.wait(lock, [&]() { return stopping || ready(); });
+                if (stopping) {
+                    break;
+                }
+            }
+            while (outstanding.size() + fresh.size() < config.pipeline_depth && ready()) {
+                size_t room = std::min(config.max_batch, config.max_in_flight - in_flight);
+                std::vector<PendingCall> batch;
+                while (batch.size() < room && !queue.empty()) {
+                    batch.push_back(std::move(queue.front()));
+                    queue.pop_front();
+                }
+                in_flight += batch.size();
+                fresh.push_back(std::move(batch));
+            }
+            peak_in_flight = std::max(peak_in_flight, in_flight);
+        }
+        
+        for (auto& batch : fresh) {
+            if (fd < 0) {
+                fd = open_connection();
+            }
+            if (fd < 0) {
+                fail_batch(batch, "connect failed: " + host + ":" + std::to_string(port));
+                continue;
+            }
+            
+            // Tek çağrı düz nesne, birden fazlası JSON-RPC batch dizisi
+            std::string body = batch.size() > 1 ? "[" : "";
+            for (size_t i = 0; i < batch.size(); ++i) {
+                body += i ? "," : "";
+                body += "{\"jsonrpc\":\"2.0\",\"id\":" + std::to_string(batch[i].id) +
+                        ",\"method\":\"" + batch[i].method + "\",\"params\":" + batch[i].params + "}";
+            }
+            body += batch.size() > 1 ? "]" : "";
+            std::string request = "POST / HTTP/1.1\r\nHost: " + host + ":" + std::to_string(port) +
+                                  "\r\nContent-Type: application/json\r\nContent-Length: " +
+                                  std::to_string(body.size()) + "\r\n\r\n" + body;
+            if (!send_all(fd, request)) {
+                fail_batch(batch, "send failed");
+                drop_connection("send failed");
+                continue;
+            }
+            posts.fetch_add(1, std::memory_order_relaxed);
+            outstanding.push_back(std::move(batch));
+        }
+        if (outstanding.empty()) {
+            continue;
+        }
         
-        double old_q = 0.0;
-        if (q_table.find(state_key) != q_table.end()) {
-            old_q = q_table[state_key];
+        // En eski POST'un yanıtı; yanıtlar gönderim sırasıyla gelir
+        int status = 0;
+        bool close_after = false;
+        std::string body;
+        if (!read_http_response(fd, buffer, status, body, close_after)) {
+            drop_connection("connection lost");
+            continue;
         }
+        std::vector<PendingCall> batch = std::move(outstanding.front());
+        outstanding.pop_front();
         
-        // Next state max Q
-        double max_next_q = 0.0;
-        if (i + 2 < path.size()) {
-            std::string next_key = hash_to_string(path[i + 1]) + "_" + hash_to_string(path[i + 2]);
-            if (q_table.find(next_key) != q_table.end()) {
-                max_next_q = q_table[next_key];
+        std::vector<RpcResponse> responses(batch.size());
+        std::vector<uint8_t> answered(batch.size(), 0);
+        auto accept = [&](std::string_view object) {
+            uint64_t id = 0;
+            RpcResponse response;
+            bool has_id = false;
+            json_for_each_member(object, [&](std::string_view key, std::string_view value) {
+                if (key == "id") {
+                    has_id = !value.empty() && std::isdigit(static_cast<unsigned char>(value[0]));
+                    id = std::strtoull(std::string(value).c_str(), nullptr, 10);
+                } else if (key == "result") {
+                    response.ok = true;
+                    response.result = std::string(value);
+                } else if (key == "error" && value != "null") {
+                    response.ok = false;
+                    response.error = std::string(value);
+                }
+                return true;
+            });
+            if (response.ok && !response.error.empty()) {
+                response.ok = false;
+            }
+            for (size_t i = 0; has_id && i < batch.size(); ++i) {
+                if (batch[i].id == id && !answered[i]) {
+                    responses[i] = std::move(response);
+                    answered[i] = 1;
+                    break;
+                }
+            }
+            return true;
+        };
+        std::string_view view(body);
+        size_t first = view.find_first_not_of(" \t\r\n");
+        if (status == 200 && first != std::string_view::npos) {
+            if (view[first] == '[') {
+                json_for_each_element(view, accept);
+            } else {
+                accept(view);
+            }
+        }
+        
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex);
+            in_flight -= batch.size();
+        }
+        queue_cv.notify_all();
+        for (size_t i = 0; i < batch.size(); ++i) {
+            if (!answered[i]) {
+                failures.fetch_add(1, std::memory_order_relaxed);
+                responses[i].error = status == 200 ? "no response for id " + std::to_string(batch[i].id)
+                                                   : "HTTP " + std::to_string(status);
             }
+            batch[i].promise.set_value(std::move(responses[i]));
         }
         
-        double new_q = old_q + learning_rate * (reward + discount_factor * max_next_q - old_q);
-        q_table[state_key] = new_q;
+        if (close_after) {
+            drop_connection("connection closed by server");
+        }
     }
+    
+    drop_connection("client stopped");
 }
 
 // ============================================================================
 // CROSS-CHAIN BRIDGE İMPLEMENTASYONU
 // ============================================================================
 
+std::string CrossChainBridge::ChainAdapter::rpc_params(const Hash256& native_tx_hash) const {
+    return "[\"" + HexHash(native_tx_hash).str() + "\"]";
+}
+
+bool CrossChainBridge::ChainAdapter::decode_rpc_result(const std::string& result, std::vector<uint8_t>& raw_tx) const {
+    std::string hex;
+    if (!json_string_value(result, hex)) {
+        return false;       // null: zincirde yok
+    }
+    size_t skip = hex.compare(0, 2, "0x") == 0 ? 2 : 0;
+    raw_tx.resize((hex.size() - skip) / 2);
+    return hex_decode(hex.data() + skip, hex.size() - skip, raw_tx.data());
+}
+
 // Bitcoin Adapter
 class BitcoinAdapter : public CrossChainBridge::ChainAdapter {
 public:
@@ -163,13 +2209,13 @@ public:
         // Bitcoin transaction parsing (simplified)
         // Gerçek implementasyonda: input/output parsing, script verification
         
-        if (raw_tx.size() > 20) {
+        if (raw_tx.size() >= 20) {
             std::memcpy(tx.from.data(), raw_tx.data(), 20);
         }
-        if (raw_tx.size() > 40) {
+        if (raw_tx.size() >= 40) {
             std::memcpy(tx.to.data(), raw_tx.data() + 20, 20);
         }
-        if (raw_tx.size() > 48) {
+        if (raw_tx.size() >= 48) {
             std::memcpy(&tx.amount, raw_tx.data() + 40, 8);
         }
         
@@ -189,6 +2235,11 @@ public:
         
         return raw_tx;
     }
+    
+    // bitcoind: getrawtransaction "<txid>" -> ham işlemin hex'i
+    std::string rpc_method() const override {
+        return "getrawtransaction";
+    }
 };
 
 // Ethereum Adapter
@@ -204,13 +2255,13 @@ public:
         tx.chain_type = ChainType::ETHEREUM;
         
         // Ethereum RLP decoding (simplified)
-        if (raw_tx.size() > 20) {
+        if (raw_tx.size() >= 20) {
             std::memcpy(tx.from.data(), raw_tx.data(), 20);
         }
-        if (raw_tx.size() > 40) {
+        if (raw_tx.size() >= 40) {
             std::memcpy(tx.to.data(), raw_tx.data() + 20, 20);
         }
-        if (raw_tx.size() > 48) {
+        if (raw_tx.size() >= 48) {
             std::memcpy(&tx.amount, raw_tx.data() + 40, 8);
         }
         
@@ -230,6 +2281,15 @@ public:
         
         return raw_tx;
     }
+    
+    // geth: eth_getRawTransactionByHash "0x<hash>" -> "0x<rlp>"
+    std::string rpc_method() const override {
+        return "eth_getRawTransactionByHash";
+    }
+    
+    std::string rpc_params(const Hash256& native_tx_hash) const override {
+        return "[\"0x" + HexHash(native_tx_hash).str() + "\"]";
+    }
 };
 
 // Solana Adapter
@@ -244,14 +2304,14 @@ public:
         Transaction tx;
         tx.chain_type = ChainType::SOLANA;
         
-        // Solana transaction parsing
-        if (raw_tx.size() > 32) {
+        // Solana transaction parsing: 32 baytlık hesaplar, adresin ilk 20 baytı
+        if (raw_tx.size() >= 32) {
             std::memcpy(tx.from.data(), raw_tx.data(), 20);
         }
-        if (raw_tx.size() > 64) {
+        if (raw_tx.size() >= 64) {
             std::memcpy(tx.to.data(), raw_tx.data() + 32, 20);
         }
-        if (raw_tx.size() > 72) {
+        if (raw_tx.size() >= 72) {
             std::memcpy(&tx.amount, raw_tx.data() + 64, 8);
         }
         
@@ -259,18 +2319,40 @@ public:
     }
     
     std::vector<uint8_t> encode_to_native(const Transaction& tx) override {
-        std::vector<uint8_t> raw_tx;
-        
-        // Encode to Solana format
-        raw_tx.insert(raw_tx.end(), tx.from.begin(), tx.from.end());
-        raw_tx.insert(raw_tx.end(), tx.to.begin(), tx.to.end());
+        std::vector<uint8_t> raw_tx(72, 0);
         
-        uint8_t amount_bytes[8];
-        std::memcpy(amount_bytes, &tx.amount, 8);
-        raw_tx.insert(raw_tx.end(), amount_bytes, amount_bytes + 8);
+        // Encode to Solana format (parse_native_tx ile aynı yerleşim)
+        std::memcpy(raw_tx.data(), tx.from.data(), tx.from.size());
+        std::memcpy(raw_tx.data() + 32, tx.to.data(), tx.to.size());
+        std::memcpy(raw_tx.data() + 64, &tx.amount, 8);
         
         return raw_tx;
     }
+    
+    // getTransaction "<imza>" {"encoding":"base64"} -> {"transaction":["<base64>","base64"],...}.
+    // Gerçek imzalar base58'dir; köprü hash'i hex olarak gönderir.
+    std::string rpc_method() const override {
+        return "getTransaction";
+    }
+    
+    std::string rpc_params(const Hash256& native_tx_hash) const override {
+        return "[\"" + HexHash(native_tx_hash).str() + "\",{\"encoding\":\"base64\"}]";
+    }
+    
+    bool decode_rpc_result(const std::string& result, std::vector<uint8_t>& raw_tx) const override {
+        std::string encoded;
+        json_for_each_member(result, [&](std::string_view key, std::string_view value) {
+            if (key != "transaction") {
+                return true;
+            }
+            json_for_each_element(value, [&](std::string_view element) {
+                json_string_value(element, encoded);
+                return false;
+            });
+            return false;
+        });
+        return !encoded.empty() && base64_decode(encoded, raw_tx);
+    }
 };
 
 CrossChainBridge::CrossChainBridge() {
@@ -293,7 +2375,7 @@ Hash256 CrossChainBridge::initiate_transfer(const Transaction& tx) {
     
     // Gerçek implementasyonda: Lock funds, notify validators
     
-    std::cout << "Bridge transfer initiated: " << hash_to_string(tx_hash) << std::endl;
+    std::cout << "Bridge transfer initiated: " << HexHash(tx_hash) << std::endl;
     
     return tx_hash;
 }
@@ -328,25 +2410,93 @@ bool CrossChainBridge::confirm_transfer(const Hash256& tx_id,
     if (valid_sigs >= required_sigs) {
         // Transfer confirmed
         pending_bridge_txs.erase(it);
-        std::cout << "Bridge transfer confirmed: " << hash_to_string(tx_id) << std::endl;
+        std::cout << "Bridge transfer confirmed: " << HexHash(tx_id) << std::endl;
         return true;
     }
     
     return false;
 }
 
-Transaction CrossChainBridge::pull_from_chain(ChainType type, const Hash256& native_tx_hash) {
+void CrossChainBridge::configure_rpc(ChainType type, const std::string& endpoint, const RpcClientConfig& config) {
+    std::shared_ptr<RpcClient> previous;
+    {
+        std::lock_guard<std::mutex> lock(rpc_mutex);
+        auto adapter_it = adapters.find(type);
+        if (adapter_it == adapters.end()) {
+            return;
+        }
+        adapter_it->second->rpc_endpoint = endpoint;
+        rpc_configs[type] = config;
+        previous = std::move(rpc_clients[type]);
+    }
+    // Başka kopya yoksa eski istemci kilit dışında kapanır (telde olan
+    // çağrılarını tamamlar); varsa son kullanıcı bıraktığında
+    previous.reset();
+}
+
+std::shared_ptr<RpcClient> CrossChainBridge::rpc_client(ChainType type) {
+    std::lock_guard<std::mutex> lock(rpc_mutex);
     auto adapter_it = adapters.find(type);
     if (adapter_it == adapters.end()) {
-        return Transaction();
+        return nullptr;
+    }
+    auto& client = rpc_clients[type];
+    if (!client) {
+        try {
+            client = std::make_shared<RpcClient>(adapter_it->second->rpc_endpoint, rpc_configs[type]);
+        } catch (const std::invalid_argument&) {
+            return nullptr;
+        }
+    }
+    return client;
+}
+
+RpcClientStats CrossChainBridge::rpc_stats(ChainType type) {
+    std::shared_ptr<RpcClient> client = rpc_client(type);
+    return client ? client->stats() : RpcClientStats();
+}
+
+std::future<Transaction> CrossChainBridge::pull_from_chain_async(ChainType type, const Hash256& native_tx_hash) {
+    std::shared_ptr<RpcClient> client = rpc_client(type);
+    if (!client) {
+        std::promise<Transaction> empty;
+        empty.set_value(Transaction());
+        return empty.get_future();
     }
     
-    // Gerçek implementasyonda: RPC call to native chain
-    // For now, return empty transaction
-    
-    std::vector<uint8_t> raw_tx; // Would fetch from chain
+    // Çağrı hemen yola çıkar; çözümleme get() çağıranın thread'inde yapılır.
+    // Future istemciyi de tutar: configure_rpc arada istemciyi değiştirse de
+    // kuyruktaki çağrı eski istemcide tamamlanır.
+    ChainAdapter* adapter = adapters.at(type).get();
+    std::future<RpcResponse> response = client->call(adapter->rpc_method(), adapter->rpc_params(native_tx_hash));
+    return std::async(std::launch::deferred, [adapter, client, response = std::move(response)]() mutable {
+        RpcResponse reply = response.get();
+        client.reset();
+        std::vector<uint8_t> raw_tx;
+        if (!reply.ok || !adapter->decode_rpc_result(reply.result, raw_tx)) {
+            return Transaction();
+        }
+        return adapter->parse_native_tx(raw_tx);
+    });
+}
+
+Transaction CrossChainBridge::pull_from_chain(ChainType type, const Hash256& native_tx_hash) {
+    return pull_from_chain_async(type, native_tx_hash).get();
+}
+
+std::vector<Transaction> CrossChainBridge::pull_from_chain(ChainType type, const std::vector<Hash256>& native_tx_hashes) {
+    std::vector<std::future<Transaction>> pending;
+    pending.reserve(native_tx_hashes.size());
+    for (const auto& hash : native_tx_hashes) {
+        pending.push_back(pull_from_chain_async(type, hash));
+    }
     
-    return adapter_it->second->parse_native_tx(raw_tx);
+    std::vector<Transaction> txs;
+    txs.reserve(pending.size());
+    for (auto& tx : pending) {
+        txs.push_back(tx.get());
+    }
+    return txs;
 }
 
 // ============================================================================
@@ -515,6 +2665,7 @@ HyperLayerNode::HyperLayerNode() : running(false) {
     dag = std::make_unique<MerkleDAG>();
     consensus = std::make_unique<AdaptiveConsensus>();
     sharding = std::make_unique<FractalSharding>();
+    executor = std::make_unique<BatchExecutor>(*sharding);
     router = std::make_unique<AIRouter>();
     bridge = std::make_unique<CrossChainBridge>();
     healing = std::make_unique<SelfHealingNetwork>();
@@ -526,6 +2677,7 @@ HyperLayerNode::HyperLayerNode() : running(false) {
     metrics.transactions_processed.store(0);
     metrics.avg_confirmation_time_ns.store(0);
     metrics.current_tps.store(0);
+    batch_height.store(0);
 }
 
 HyperLayerNode::~HyperLayerNode() {
@@ -534,7 +2686,7 @@ HyperLayerNode::~HyperLayerNode() {
 
 bool HyperLayerNode::initialize(uint16_t port) {
     std::cout << "Initializing HyperLayer Node on port " << port << std::endl;
-    std::cout << "Node Public Key: " << hash_to_string(Hash256(node_public_key)) << std::endl;
+    std::cout << "Node Public Key: " << HexHash(Hash256(node_public_key)) << std::endl;
     
     // Initialize network components
     // Gerçek implementasyonda: Socket binding, peer discovery
@@ -542,6 +2694,33 @@ bool HyperLayerNode::initialize(uint16_t port) {
     return true;
 }
 
+bool HyperLayerNode::enable_durability(const DurabilityConfig& config) {
+    if (running.load() || journal) {
+        return false;
+    }
+    
+    try {
+        auto wal = std::make_unique<WriteAheadLog>(config);
+        WalRecoveryResult recovered = wal->recover(*sharding);
+        
+        // Kurtarılan yükseklik log'a bağlanmadan yayınlanır (tekrar yazılmaz)
+        sharding->publish_snapshots(recovered.recovered_height);
+        batch_height.store(recovered.recovered_height);
+        sharding->attach_journal(wal.get());
+        journal = std::move(wal);
+        
+        std::cout << "State recovered from " << config.directory
+                  << ": height " << recovered.recovered_height
+                  << " (checkpoint " << recovered.checkpoint_height
+                  << ", " << recovered.records_replayed << " log records"
+                  << (recovered.torn_tail ? ", torn tail truncated" : "") << ")" << std::endl;
+        return true;
+    } catch (const std::exception& e) {
+        std::cerr << "Durability disabled: " << e.what() << std::endl;
+        return false;
+    }
+}
+
 void HyperLayerNode::start() {
     if (running.load()) {
         return;
@@ -586,6 +2765,11 @@ void HyperLayerNode::stop() {
         network_thread.join();
     }
     
+    // fsync_every_batches > 1 ise bekleyen son batch'ler
+    if (journal) {
+        journal->sync();
+    }
+    
     std::cout << "HyperLayer Node stopped" << std::endl;
 }
 
@@ -610,9 +2794,17 @@ void HyperLayerNode::transaction_processor() {
         if (!batch.empty()) {
             auto start = std::chrono::high_resolution_clock::now();
             
-            // Process batch through sharding
-            for (const auto& tx : batch) {
-                sharding->route_transaction(tx);
+            // Process batch through sharding (shard başına paralel)
+            executor->execute(batch);
+            
+            // Sıcak shard'ları böl, soğuk kardeşleri birleştir (batch sınırında)
+            sharding->rebalance();
+            
+            // State root'lar transaction başına değil batch başına bir kez;
+            // okuyucular için yeni yükseklikte görüntü yayınlanır. execute()
+            // döndüğünde batch yerleşmiştir; yükseklik yalnızca yayınlanırsa ilerler.
+            if (sharding->publish_snapshots(batch_height.load() + 1)) {
+                batch_height.fetch_add(1);
             }
             
             auto end = std::chrono::high_resolution_clock::now();
@@ -639,7 +2831,8 @@ void HyperLayerNode::transaction_processor() {
 
 void HyperLayerNode::consensus_loop() {
     while (running.load()) {
-        std::vector<Transaction> batch;
+        // Proposal yalnızca tx hash'lerini taşır; Transaction kopyalanmaz
+        std::vector<Hash256> tx_hashes;
         
         {
             std::lock_guard<std::mutex> lock(mempool_mutex);
@@ -647,25 +2840,31 @@ void HyperLayerNode::consensus_loop() {
             // Take transactions for consensus
             size_t batch_size = std::min(size_t(100), mempool.size());
             
-            if (batch_size > 0) {
-                batch.insert(batch.end(), 
-                           mempool.begin(), 
-                           mempool.begin() + batch_size);
+            tx_hashes.reserve(batch_size);
+            for (size_t i = 0; i < batch_size; ++i) {
+                tx_hashes.push_back(mempool[i].tx_id);
             }
         }
         
-        if (!batch.empty()) {
+        if (!tx_hashes.empty()) {
             // Adjust consensus mode based on load
             consensus->adjust_mode(metrics.current_tps.load());
             
             // Select validators
             auto validators = consensus->select_validators(VALIDATOR_MINIMUM);
             
+            // Batch ağacı bir kez kurulur ve oylamaya taşınır (kök commit'e girer).
+            // Node'un henüz peer taşıması yok: kompakt proposal gönderme/alma
+            // yolu node'da uygulanmadı (CompactRelay'i yalnızca relay benchmark'ı
+            // kullanır, simülatör baytları SHORT_TXID_BYTES ile modeller).
+            BatchMerkleTree tree;
+            tree.build(tx_hashes);
+            
             // Reach consensus
-            bool consensus_reached = consensus->reach_consensus(batch, validators);
+            bool consensus_reached = consensus->reach_consensus(std::move(tree), validators);
             
             if (consensus_reached) {
-                std::cout << "Consensus reached for batch of " << batch.size() 
+                std::cout << "Consensus reached for batch of " << tx_hashes.size() 
                          << " transactions" << std::endl;
             }
         }
@@ -698,13 +2897,14 @@ Hash256 HyperLayerNode::submit_transaction(const Transaction& tx) {
     
     Hash256 tx_hash = tx.compute_hash(*crypto);
     
-    // Add to mempool
+    // Add to mempool (hash proposal'lar için saklanır)
     {
         std::lock_guard<std::mutex> lock(mempool_mutex);
         mempool.push_back(tx);
+        mempool.back().tx_id = tx_hash;
     }
     
-    std::cout << "Transaction submitted: " << hash_to_string(tx_hash) << std::endl;
+    std::cout << "Transaction submitted: " << HexHash(tx_hash) << std::endl;
     
     return tx_hash;
 }
@@ -744,18 +2944,26 @@ bool HyperLayerNode::connect_to_peer(const std::string& ip, uint16_t port) {
 }
 
 uint64_t HyperLayerNode::get_balance(const Address& addr, uint32_t shard_id) {
-    const ShardState* shard = sharding->get_shard_state(shard_id);
-    
-    if (shard == nullptr) {
+    if (shard_id >= SHARD_COUNT) {
         return 0;
     }
     
-    auto it = shard->balances.find(addr);
-    if (it != shard->balances.end()) {
-        return it->second;
+    // Son kesinleşmiş batch'in görüntüsünden, yürütmeyi bloklamadan.
+    // Bölgeler taşınabildiğinden shard_id yalnızca ipucu; sahibi görüntü belirler.
+    uint64_t balance = 0;
+    auto snap = sharding->snapshot();
+    if (!snap->shards[shard_id]->find(addr, balance)) {
+        balance = snap->balance_of(addr);
     }
-    
-    return 0;
+    return balance;
+}
+
+std::shared_ptr<const StateSnapshot> HyperLayerNode::get_state_snapshot(uint64_t height) const {
+    return height == 0 ? sharding->snapshot() : sharding->snapshot_at(height);
+}
+
+TelemetrySnapshot HyperLayerNode::get_shard_telemetry(bool reset) {
+    return sharding->telemetry(reset);
 }
 
 } // namespace HyperLayer
@@ -0,0 +1,2342 @@
+// hyperlayer_core_part3.cpp
+// HyperLayer Protocol - Simulation & Execution Engines
+
+#include "hyperlayer_core.hpp"
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <thread>
+#include <fstream>
+#include <filesystem>
+#include <cerrno>
+#include <cstdio>
+#include <deque>
+#include <fcntl.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#if defined(__SSE4_2__)
+#include <nmmintrin.h>
+#endif
+
+namespace HyperLayer {
+
+// ============================================================================
+// KONSENSÜS SİMÜLATÖRÜ İMPLEMENTASYONU
+// ============================================================================
+
+namespace {
+
+enum SimMessageType : uint8_t {
+    MSG_PROPOSE = 0,
+    MSG_PREPARE = 1,
+    MSG_COMMIT = 2,
+    MSG_DECIDE = 3,
+    MSG_VIEW_CHANGE = 4,
+    MSG_FETCH = 5,      // kompakt proposal: eksik tx isteği
+    MSG_FILL = 6        // kompakt proposal: eksik tx'ler
+};
+
+enum SimEventKind : uint8_t {
+    EVENT_DELIVER = 0,
+    EVENT_TIMER = 1
+};
+
+// Wire boyutları: tx_id + chain + from + to + amount/fee/nonce/ts + imza
+constexpr uint64_t TX_WIRE_BYTES = 32 + 1 + 20 + 20 + 4 * 8 + 64;
+// type + sender + seq + view + root + imza
+constexpr uint64_t VOTE_WIRE_BYTES = 1 + 4 + 8 + 4 + 32 + 64;
+
+uint64_t ms_to_ns(double ms) {
+    return static_cast<uint64_t>(ms * 1e6);
+}
+
+} // namespace
+
+SimulationConfig::SimulationConfig()
+    : node_count(VALIDATOR_MINIMUM),
+      byzantine_count(0),
+      byzantine_behavior(ByzantineBehavior::SILENT),
+      batch_size(1000),
+      batch_count(50),
+      offered_tps(5000),
+      link_latency_ms(20.0),
+      link_jitter_ms(5.0),
+      packet_loss(0.0),
+      uplink_mbps(100.0),
+      verify_us_per_tx(2.0),
+      view_timeout_ms(1000.0),
+      compact_proposals(false),
+      mempool_overlap(0.99),
+      seed(1) {}
+
+SimulationReport::SimulationReport()
+    : mode(ConsensusMode::BALANCED),
+      committed_batches(0),
+      view_changes(0),
+      latency_p50_ms(0), latency_p90_ms(0), latency_p99_ms(0), latency_max_ms(0),
+      throughput_tps(0), simulated_ms(0),
+      messages_sent(0), messages_dropped(0), bytes_sent(0),
+      proposal_bytes(0), propagation_p50_ms(0) {}
+
+struct ConsensusSimulator::Message {
+    uint8_t type;
+    uint32_t sender;
+    uint64_t seq;
+    uint32_t view;
+    Hash256 root;
+    uint32_t tx_count;  // FETCH/FILL: taşınan tx sayısı
+};
+
+struct ConsensusSimulator::Event {
+    uint64_t time_ns;
+    uint64_t order;
+    uint8_t kind;
+    uint32_t target;
+    Message msg;
+};
+
+struct ConsensusSimulator::Node {
+    uint32_t id;
+    bool byzantine;
+    AdaptiveConsensus consensus;
+    
+    uint64_t seq;                 // karar verilmeye çalışılan batch
+    uint32_t view;
+    bool has_proposal;
+    Hash256 proposal_root;
+    bool sent_commit;
+    bool awaiting_fill;
+    Hash256 pending_root;
+    uint32_t highest_view_change;
+    uint32_t timer_backoff;
+    
+    // vote_key -> oy veren node'lar (çift oy sayılmasın diye)
+    std::unordered_map<Hash256, std::vector<bool>, ArrayHash> voters;
+    std::unordered_map<uint32_t, std::vector<bool>> view_change_voters;
+    
+    std::vector<Hash256> decided;  // seq -> commit edilen kök
+    std::vector<Message> future;   // henüz girilmemiş seq/view mesajları
+    
+    uint64_t uplink_free_ns;
+    
+    Node(uint32_t node_id, bool is_byzantine)
+        : id(node_id), byzantine(is_byzantine), seq(0), view(0),
+          has_proposal(false), proposal_root{0}, sent_commit(false),
+          awaiting_fill(false), pending_root{0}, highest_view_change(0), timer_backoff(0), uplink_free_ns(0) {}
+};
+
+ConsensusSimulator::ConsensusSimulator(const SimulationConfig& cfg)
+    : config(cfg), now_ns(0), event_order(0), rng_state(cfg.seed) {
+    
+    if (config.node_count < 1) {
+        config.node_count = 1;
+    }
+    config.byzantine_count = std::min(config.byzantine_count, config.node_count - 1);
+    
+    // Byzantine node'ları seed'e göre karıştırarak seç
+    std::vector<uint32_t> order(config.node_count);
+    for (uint32_t i = 0; i < config.node_count; ++i) {
+        order[i] = i;
+    }
+    for (uint32_t i = config.node_count; i > 1; --i) {
+        uint32_t j = static_cast<uint32_t>(next_uniform() * i);
+        std::swap(order[i - 1], order[std::min(j, i - 1)]);
+    }
+    
+    std::vector<bool> is_byzantine(config.node_count, false);
+    for (uint32_t i = 0; i < config.byzantine_count; ++i) {
+        is_byzantine[order[i]] = true;
+    }
+    
+    for (uint32_t i = 0; i < config.node_count; ++i) {
+        nodes.push_back(std::make_unique<Node>(i, is_byzantine[i]));
+        nodes.back()->consensus.adjust_mode(config.offered_tps);
+    }
+    
+    batch_start_ns.assign(config.batch_count, 0);
+    batch_honest_commits.assign(config.batch_count, 0);
+    proposal_sent_ns.assign(config.batch_count, 0);
+}
+
+ConsensusSimulator::~ConsensusSimulator() {}
+
+uint32_t ConsensusSimulator::fault_tolerance() const {
+    return (config.node_count - 1) / 3;
+}
+
+uint32_t ConsensusSimulator::leader_of(uint64_t seq, uint32_t view) const {
+    return static_cast<uint32_t>((seq + view) % config.node_count);
+}
+
+bool ConsensusSimulator::three_phase() const {
+    // HIGH_SPEED modunda prepare turu atlanır (propose -> commit)
+    return report.mode != ConsensusMode::HIGH_SPEED;
+}
+
+double ConsensusSimulator::next_uniform() {
+    // splitmix64: platformdan bağımsız, tekrarlanabilir
+    uint64_t z = (rng_state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    z ^= z >> 31;
+    return static_cast<double>(z >> 11) * (1.0 / 9007199254740992.0);
+}
+
+bool ConsensusSimulator::event_later(const Event& a, const Event& b) {
+    if (a.time_ns != b.time_ns) {
+        return a.time_ns > b.time_ns;
+    }
+    return a.order > b.order;
+}
+
+void ConsensusSimulator::schedule(const Event& event) {
+    event_heap.push_back(event);
+    event_heap.back().order = event_order++;
+    std::push_heap(event_heap.begin(), event_heap.end(), event_later);
+}
+
+Hash256 ConsensusSimulator::vote_key(uint8_t phase, uint64_t seq,
+                                     uint32_t view, const Hash256& root) const {
+    // (phase, seq, view) köke XOR'lanır: sabit bir tur için kökten anahtara
+    // birebir eşleme, her mesajda hash maliyeti yok
+    Hash256 key = root;
+    key[0] ^= phase;
+    for (int i = 0; i < 8; ++i) {
+        key[1 + i] ^= static_cast<uint8_t>(seq >> (8 * i));
+    }
+    for (int i = 0; i < 4; ++i) {
+        key[9 + i] ^= static_cast<uint8_t>(view >> (8 * i));
+    }
+    return key;
+}
+
+void ConsensusSimulator::send(uint32_t from, uint32_t to, const Message& msg) {
+    Node& sender = *nodes[from];
+    
+    uint64_t bytes = VOTE_WIRE_BYTES;
+    uint64_t verify_txs = 0;
+    
+    if (msg.type == MSG_PROPOSE) {
+        if (config.compact_proposals) {
+            // salt + kısa ID'ler; mempool tx'leri kabulde zaten doğrulandı
+            bytes += 8 + 4 + static_cast<uint64_t>(config.batch_size) * SHORT_TXID_BYTES;
+        } else {
+            bytes += 4 + static_cast<uint64_t>(config.batch_size) * TX_WIRE_BYTES;
+            verify_txs = config.batch_size;
+        }
+    } else if (msg.type == MSG_FETCH) {
+        bytes += 4 + static_cast<uint64_t>(msg.tx_count) * 4;
+    } else if (msg.type == MSG_FILL) {
+        bytes += 4 + static_cast<uint64_t>(msg.tx_count) * TX_WIRE_BYTES;
+        verify_txs = msg.tx_count;
+    }
+    
+    // Gönderenin uplink'i mesajları sırayla serileştirir
+    double tx_ns = (bytes * 8.0) / (config.uplink_mbps * 1e6) * 1e9;
+    uint64_t depart = std::max(now_ns, sender.uplink_free_ns) + static_cast<uint64_t>(tx_ns);
+    sender.uplink_free_ns = depart;
+    
+    report.messages_sent++;
+    report.bytes_sent += bytes;
+    if (msg.type == MSG_PROPOSE || msg.type == MSG_FETCH || msg.type == MSG_FILL) {
+        report.proposal_bytes += bytes;
+    }
+    
+    if (next_uniform() < config.packet_loss) {
+        report.messages_dropped++;
+        return;
+    }
+    
+    uint64_t arrival = depart + ms_to_ns(config.link_latency_ms + next_uniform() * config.link_jitter_ms);
+    arrival += ms_to_ns(config.verify_us_per_tx * verify_txs / 1000.0);
+    
+    Event event;
+    event.time_ns = arrival;
+    event.kind = EVENT_DELIVER;
+    event.target = to;
+    event.msg = msg;
+    schedule(event);
+}
+
+void ConsensusSimulator::broadcast(uint32_t from, const Message& msg) {
+    for (uint32_t to = 0; to < config.node_count; ++to) {
+        if (to != from) {
+            send(from, to, msg);
+        }
+    }
+}
+
+void ConsensusSimulator::arm_timer(uint32_t node_id) {
+    Node& node = *nodes[node_id];
+    
+    Event event;
+    event.time_ns = now_ns + ms_to_ns(config.view_timeout_ms) * (1ULL << std::min(node.timer_backoff, 6u));
+    event.kind = EVENT_TIMER;
+    event.target = node_id;
+    event.msg.type = MSG_VIEW_CHANGE;
+    event.msg.sender = node_id;
+    event.msg.seq = node.seq;
+    event.msg.view = node.view;
+    event.msg.root = Hash256{0};
+    event.msg.tx_count = 0;
+    schedule(event);
+}
+
+void ConsensusSimulator::start_sequence(uint32_t node_id) {
+    Node& node = *nodes[node_id];
+    
+    node.view = 0;
+    node.has_proposal = false;
+    node.sent_commit = false;
+    node.awaiting_fill = false;
+    node.highest_view_change = 0;
+    node.timer_backoff = 0;
+    node.voters.clear();
+    node.view_change_voters.clear();
+    node.consensus.clear_votes();
+    
+    if (node.seq >= config.batch_count) {
+        return;
+    }
+    
+    if (!node.byzantine && batch_start_ns[node.seq] == 0) {
+        batch_start_ns[node.seq] = std::max<uint64_t>(now_ns, 1);
+    }
+    
+    arm_timer(node_id);
+    
+    if (leader_of(node.seq, 0) == node_id) {
+        propose(node_id);
+    }
+    
+    // Bu seq için önceden gelmiş mesajları yeniden işle
+    std::vector<Message> pending;
+    pending.swap(node.future);
+    for (const auto& msg : pending) {
+        handle_message(node_id, msg);
+    }
+}
+
+void ConsensusSimulator::propose(uint32_t node_id) {
+    Node& node = *nodes[node_id];
+    
+    if (node.byzantine && config.byzantine_behavior == ByzantineBehavior::SILENT) {
+        return;
+    }
+    
+    if (node.view > 0) {
+        report.view_changes++;
+    }
+    
+    // Batch commitment: sentetik transaction hash'leri üzerinde Merkle kökü
+    QuantumCrypto crypto;
+    std::vector<Hash256> tx_hashes(config.batch_size);
+    for (uint32_t i = 0; i < config.batch_size; ++i) {
+        uint64_t input[3] = {config.seed, node.seq, i};
+        tx_hashes[i] = crypto.hash(reinterpret_cast<const uint8_t*>(input), sizeof(input));
+    }
+    BatchMerkleTree tree;
+    tree.build(tx_hashes);
+    
+    Message msg;
+    msg.type = MSG_PROPOSE;
+    msg.sender = node_id;
+    msg.seq = node.seq;
+    msg.view = node.view;
+    msg.root = tree.root();
+    msg.tx_count = 0;
+    
+    proposal_sent_ns[node.seq] = now_ns;
+    
+    if (node.byzantine) {
+        // Equivocation: node'ların yarısına farklı kök gönder
+        Message forged = msg;
+        forged.root[0] ^= 0xff;
+        for (uint32_t to = 0; to < config.node_count; ++to) {
+            if (to != node_id) {
+                send(node_id, to, (to % 2 == 0) ? msg : forged);
+            }
+        }
+        return;
+    }
+    
+    broadcast(node_id, msg);
+    handle_message(node_id, msg);
+}
+
+void ConsensusSimulator::handle_message(uint32_t node_id, const Message& msg) {
+    Node& node = *nodes[node_id];
+    
+    if (node.byzantine && config.byzantine_behavior == ByzantineBehavior::SILENT) {
+        return;
+    }
+    
+    // Eksik tx isteği: proposer seq'i geçmiş olsa bile cevaplar
+    if (msg.type == MSG_FETCH) {
+        Message fill = msg;
+        fill.type = MSG_FILL;
+        fill.sender = node_id;
+        send(node_id, msg.sender, fill);
+        return;
+    }
+    
+    // Geride kalan göndericiye karar verilmiş kökü bildir (catch-up)
+    if (msg.seq < node.seq) {
+        if (msg.type != MSG_DECIDE && msg.seq < node.decided.size() && !node.byzantine) {
+            Message decide;
+            decide.type = MSG_DECIDE;
+            decide.sender = node_id;
+            decide.seq = msg.seq;
+            decide.view = 0;
+            decide.root = node.decided[msg.seq];
+            decide.tx_count = 0;
+            send(node_id, msg.sender, decide);
+        }
+        return;
+    }
+    
+    if (node.seq >= config.batch_count) {
+        return;
+    }
+    
+    bool future_view = msg.view > node.view &&
+                       msg.type != MSG_VIEW_CHANGE && msg.type != MSG_DECIDE;
+    if (msg.seq > node.seq || future_view) {
+        node.future.push_back(msg);
+        return;
+    }
+    
+    uint32_t quorum = AdaptiveConsensus::quorum_size(config.node_count);
+    
+    switch (msg.type) {
+        case MSG_PROPOSE: {
+            if (msg.view != node.view || node.has_proposal || node.awaiting_fill ||
+                msg.sender != leader_of(node.seq, node.view)) {
+                return;
+            }
+            
+            if (config.compact_proposals && msg.sender != node_id) {
+                // Batch yerel mempool'dan kurulur; bulunamayanlar leader'dan istenir
+                uint32_t missing = 0;
+                for (uint32_t i = 0; i < config.batch_size; ++i) {
+                    if (next_uniform() >= config.mempool_overlap) {
+                        missing++;
+                    }
+                }
+                
+                if (missing > 0) {
+                    node.awaiting_fill = true;
+                    node.pending_root = msg.root;
+                    
+                    Message fetch = msg;
+                    fetch.type = MSG_FETCH;
+                    fetch.sender = node_id;
+                    fetch.tx_count = missing;
+                    send(node_id, msg.sender, fetch);
+                    return;
+                }
+            }
+            
+            accept_proposal(node_id, msg.root);
+            return;
+        }
+        
+        case MSG_FILL: {
+            if (msg.view != node.view || !node.awaiting_fill || msg.root != node.pending_root) {
+                return;
+            }
+            
+            node.awaiting_fill = false;
+            accept_proposal(node_id, msg.root);
+            return;
+        }
+        
+        case MSG_PREPARE:
+        case MSG_COMMIT:
+        case MSG_DECIDE: {
+            if (msg.type != MSG_DECIDE && msg.view != node.view) {
+                return;
+            }
+            
+            Hash256 key = vote_key(msg.type, msg.seq, msg.type == MSG_DECIDE ? 0 : msg.view, msg.root);
+            auto& seen = node.voters[key];
+            if (seen.empty()) {
+                seen.assign(config.node_count, false);
+            }
+            if (seen[msg.sender]) {
+                return;
+            }
+            seen[msg.sender] = true;
+            
+            uint32_t count = node.consensus.record_vote(key);
+            
+            if (msg.type == MSG_DECIDE) {
+                // f+1 eş karar en az bir dürüst node'dan gelir
+                if (count >= fault_tolerance() + 1) {
+                    commit(node_id, msg.root);
+                }
+                return;
+            }
+            
+            if (msg.type == MSG_PREPARE && count >= quorum && !node.sent_commit) {
+                node.sent_commit = true;
+                
+                Message vote = msg;
+                vote.type = MSG_COMMIT;
+                vote.sender = node_id;
+                if (node.byzantine) {
+                    vote.root[0] ^= 0xff;
+                }
+                
+                broadcast(node_id, vote);
+                handle_message(node_id, vote);
+                return;
+            }
+            
+            if (msg.type == MSG_COMMIT && count >= quorum) {
+                commit(node_id, msg.root);
+            }
+            return;
+        }
+        
+        case MSG_VIEW_CHANGE: {
+            if (msg.view <= node.view) {
+                return;
+            }
+            
+            auto& seen = node.view_change_voters[msg.view];
+            if (seen.empty()) {
+                seen.assign(config.node_count, false);
+            }
+            if (seen[msg.sender]) {
+                return;
+            }
+            seen[msg.sender] = true;
+            
+            uint32_t count = static_cast<uint32_t>(std::count(seen.begin(), seen.end(), true));
+            
+            // f+1 talep varsa en az bir dürüst node zaman aşımına uğramıştır: katıl
+            if (count >= fault_tolerance() + 1 && node.highest_view_change < msg.view) {
+                node.highest_view_change = msg.view;
+                
+                Message join = msg;
+                join.sender = node_id;
+                broadcast(node_id, join);
+                handle_message(node_id, join);
+                return;
+            }
+            
+            if (count >= quorum) {
+                node.view = msg.view;
+                node.has_proposal = false;
+                node.awaiting_fill = false;
+                node.sent_commit = false;
+                arm_timer(node_id);
+                
+                if (leader_of(node.seq, node.view) == node_id) {
+                    propose(node_id);
+                }
+                
+                std::vector<Message> pending;
+                pending.swap(node.future);
+                for (const auto& m : pending) {
+                    handle_message(node_id, m);
+                }
+            }
+            return;
+        }
+        
+        default:
+            return;
+    }
+}
+
+void ConsensusSimulator::accept_proposal(uint32_t node_id, const Hash256& root) {
+    Node& node = *nodes[node_id];
+    
+    node.has_proposal = true;
+    node.proposal_root = root;
+    
+    if (!node.byzantine && leader_of(node.seq, node.view) != node_id) {
+        propagation_ms.push_back((now_ns - proposal_sent_ns[node.seq]) / 1e6);
+    }
+    
+    Message vote;
+    vote.type = three_phase() ? MSG_PREPARE : MSG_COMMIT;
+    vote.sender = node_id;
+    vote.seq = node.seq;
+    vote.view = node.view;
+    vote.root = root;
+    vote.tx_count = 0;
+    if (node.byzantine) {
+        vote.root[0] ^= 0xff;
+    }
+    
+    if (vote.type == MSG_COMMIT) {
+        node.sent_commit = true;
+    }
+    
+    broadcast(node_id, vote);
+    handle_message(node_id, vote);
+}
+
+void ConsensusSimulator::handle_timer(uint32_t node_id, uint64_t seq, uint32_t view) {
+    Node& node = *nodes[node_id];
+    
+    if (node.seq != seq || node.view != view || node.seq >= config.batch_count) {
+        return; // Eski timer
+    }
+    if (node.byzantine && config.byzantine_behavior == ByzantineBehavior::SILENT) {
+        return;
+    }
+    
+    node.timer_backoff++;
+    node.highest_view_change = std::max(node.highest_view_change, view + 1);
+    
+    Message msg;
+    msg.type = MSG_VIEW_CHANGE;
+    msg.sender = node_id;
+    msg.seq = seq;
+    msg.view = view + 1;
+    msg.root = Hash256{0};
+    msg.tx_count = 0;
+    
+    // Kayıp mesajlara karşı timer her tetiklendiğinde yeniden yayınlanır
+    arm_timer(node_id);
+    broadcast(node_id, msg);
+    handle_message(node_id, msg);
+}
+
+void ConsensusSimulator::commit(uint32_t node_id, const Hash256& root) {
+    Node& node = *nodes[node_id];
+    uint64_t seq = node.seq;
+    
+    node.decided.push_back(root);
+    
+    if (!node.byzantine) {
+        uint32_t honest = config.node_count - config.byzantine_count;
+        uint32_t needed = std::min(AdaptiveConsensus::quorum_size(config.node_count), honest);
+        
+        if (++batch_honest_commits[seq] == needed) {
+            report.committed_batches++;
+            batch_latencies_ms.push_back((now_ns - batch_start_ns[seq]) / 1e6);
+            report.simulated_ms = now_ns / 1e6;
+        }
+    }
+    
+    node.seq++;
+    start_sequence(node_id);
+}
+
+SimulationReport ConsensusSimulator::run() {
+    report = SimulationReport();
+    report.mode = nodes[0]->consensus.get_current_mode();
+    
+    for (uint32_t i = 0; i < config.node_count; ++i) {
+        start_sequence(i);
+    }
+    
+    // Canlılık kaybolursa sonsuz timer döngüsünü kes
+    uint64_t deadline = ms_to_ns(config.view_timeout_ms) * 64 * (config.batch_count + 1) +
+                        ms_to_ns(60000.0);
+    
+    while (!event_heap.empty() && report.committed_batches < config.batch_count) {
+        std::pop_heap(event_heap.begin(), event_heap.end(), event_later);
+        Event event = event_heap.back();
+        event_heap.pop_back();
+        
+        if (event.time_ns > deadline) {
+            break;
+        }
+        now_ns = event.time_ns;
+        
+        if (event.kind == EVENT_TIMER) {
+            handle_timer(event.target, event.msg.seq, event.msg.view);
+        } else {
+            handle_message(event.target, event.msg);
+        }
+    }
+    
+    if (!batch_latencies_ms.empty()) {
+        std::vector<double> sorted = batch_latencies_ms;
+        std::sort(sorted.begin(), sorted.end());
+        
+        auto percentile = [&sorted](double p) {
+            size_t rank = static_cast<size_t>(std::ceil(p * sorted.size()));
+            return sorted[std::min(sorted.size() - 1, rank > 0 ? rank - 1 : 0)];
+        };
+        
+        report.latency_p50_ms = percentile(0.50);
+        report.latency_p90_ms = percentile(0.90);
+        report.latency_p99_ms = percentile(0.99);
+        report.latency_max_ms = sorted.back();
+    }
+    
+    if (!propagation_ms.empty()) {
+        std::vector<double> sorted = propagation_ms;
+        std::nth_element(sorted.begin(), sorted.begin() + sorted.size() / 2, sorted.end());
+        report.propagation_p50_ms = sorted[sorted.size() / 2];
+    }
+    
+    if (report.simulated_ms > 0) {
+        report.throughput_tps = (static_cast<double>(report.committed_batches) * config.batch_size) /
+                                (report.simulated_ms / 1000.0);
+    }
+    
+    return report;
+}
+
+// ============================================================================
+// PARALEL BATCH YÜRÜTME İMPLEMENTASYONU
+// ============================================================================
+
+BatchExecutor::BatchExecutor(FractalSharding& sharding, size_t worker_count)
+    : sharding(sharding), job_generation(0), busy_workers(0), stopping(false),
+      job_fn(nullptr), job_count(0), next_item(0) {
+    if (worker_count == 0) {
+        worker_count = std::max(1u, std::thread::hardware_concurrency());
+    }
+    
+    // Çağıran thread de iş aldığı için bir eksik worker yeterli
+    for (size_t i = 1; i < worker_count; ++i) {
+        workers.emplace_back(&BatchExecutor::worker_loop, this);
+    }
+}
+
+BatchExecutor::~BatchExecutor() {
+    {
+        std::lock_guard<std::mutex> lock(pool_mutex);
+        stopping = true;
+    }
+    work_cv.notify_all();
+    
+    for (auto& worker : workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+void BatchExecutor::worker_loop() {
+    uint64_t seen_generation = 0;
+    
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(pool_mutex);
+            work_cv.wait(lock, [&]() { return stopping || job_generation != seen_generation; });
+            if (stopping) {
+                return;
+            }
+            seen_generation = job_generation;
+        }
+        
+        drain_items();
+        
+        {
+            std::lock_guard<std::mutex> lock(pool_mutex);
+            if (--busy_workers == 0) {
+                done_cv.notify_one();
+            }
+        }
+    }
+}
+
+void BatchExecutor::drain_items() {
+    const auto& fn = *job_fn;
+    
+    while (true) {
+        size_t item = next_item.fetch_add(1, std::memory_order_relaxed);
+        if (item >= job_count) {
+            return;
+        }
+        fn(item);
+    }
+}
+
+void BatchExecutor::run_parallel(size_t count, const std::function<void(size_t)>& fn) {
+    job_fn = &fn;
+    job_count = count;
+    next_item.store(0, std::memory_order_relaxed);
+    
+    if (workers.empty() || count <= 1) {
+        drain_items();
+    } else {
+        {
+            std::lock_guard<std::mutex> lock(pool_mutex);
+            busy_workers = workers.size();
+            ++job_generation;
+        }
+        work_cv.notify_all();
+        
+        drain_items();
+        
+        std::unique_lock<std::mutex> lock(pool_mutex);
+        done_cv.wait(lock, [&]() { return busy_workers == 0; });
+    }
+    
+    job_fn = nullptr;
+    job_count = 0;
+}
+
+BatchExecutionResult BatchExecutor::execute(const std::vector<Transaction>& batch) {
+    BatchExecutionResult result;
+    result.applied.assign(batch.size(), 0);
+    
+    // Bölümleme: her tx gönderenin shard'ına, batch sırasıyla
+    std::vector<std::vector<uint32_t>> per_shard(SHARD_COUNT);
+    for (uint32_t i = 0; i < batch.size(); ++i) {
+        per_shard[sharding.shard_of(batch[i].from)].push_back(i);
+    }
+    
+    std::vector<std::vector<uint32_t>> buckets;
+    for (auto& bucket : per_shard) {
+        if (!bucket.empty()) {
+            buckets.push_back(std::move(bucket));
+        }
+    }
+    
+    // Büyük bucket'lar önce: son biten worker'ın kuyruğunu kısaltır
+    std::stable_sort(buckets.begin(), buckets.end(),
+        [](const std::vector<uint32_t>& a, const std::vector<uint32_t>& b) {
+            return a.size() > b.size();
+        });
+    
+    // Faz 1: kaynak shard başına, batch sırasıyla. Etiket = indeks + 1
+    // (0 etiketi route_transaction'ın varsayılanı, bu batch'e ait değil)
+    std::vector<size_t> cross_counts(buckets.size(), 0);
+    run_parallel(buckets.size(), [&](size_t b) {
+        const auto& bucket = buckets[b];
+        uint32_t shard_id = sharding.shard_of(batch[bucket.front()].from);
+        
+        for (uint32_t idx : bucket) {
+            const auto& tx = batch[idx];
+            bool ok;
+            if (sharding.shard_of(tx.to) == shard_id) {
+                ok = sharding.update_shard_state(shard_id, tx);
+            } else {
+                ok = sharding.process_cross_shard(tx, static_cast<uint64_t>(idx) + 1);
+                cross_counts[b] += ok ? 1 : 0;
+            }
+            result.applied[idx] = ok ? 1 : 0;
+        }
+    });
+    
+    // Faz 2: hedef shard başına kredi teslimi
+    // Faz 3: kaynak shard başına ack; reddedilenler iade edilir
+    // Bölge taşıması sırasında yeni sahibine iletilen mesajlar için tüm
+    // krediler ve ack'ler yerine ulaşana kadar tekrarlanır; aksi halde applied
+    // henüz kesinleşmemiş transferleri başarılı sayar.
+    std::vector<std::vector<uint64_t>> rolled_back(SHARD_COUNT);
+    size_t rounds = 0;
+    do {
+        run_parallel(SHARD_COUNT, [&](size_t shard) {
+            sharding.deliver_cross_shard(static_cast<uint32_t>(shard));
+        });
+        
+        run_parallel(SHARD_COUNT, [&](size_t shard) {
+            sharding.process_acks(static_cast<uint32_t>(shard), &rolled_back[shard]);
+        });
+        ++rounds;
+    } while (sharding.cross_shard_in_flight() > 0 && rounds < MAX_SETTLE_ROUNDS);
+    
+    // Sınır yalnızca taşıma hiç durmazsa aşılır; sessizce geçilmez
+    result.unsettled_count = sharding.cross_shard_in_flight();
+    if (result.unsettled_count > 0) {
+        std::cerr << "BatchExecutor: " << result.unsettled_count
+                  << " cross-shard messages still in flight after " << rounds
+                  << " rounds" << std::endl;
+    }
+    
+    // Sıcak alıcıların delta blokları hesap başına tek yazımda işlenir
+    sharding.flush_credit_deltas();
+    
+    for (const auto& tags : rolled_back) {
+        for (uint64_t tag : tags) {
+            if (tag > 0 && tag <= batch.size() && result.applied[tag - 1]) {
+                result.applied[tag - 1] = 0;
+                ++result.rolled_back_count;
+            }
+        }
+    }
+    
+    for (size_t c : cross_counts) {
+        result.cross_shard_count += c;
+    }
+    for (uint8_t ok : result.applied) {
+        result.applied_count += ok;
+    }
+    result.rejected_count = batch.size() - result.applied_count;
+    
+    return result;
+}
+
+// ============================================================================
+// İYİMSER (BLOCK-STM) YÜRÜTME İMPLEMENTASYONU
+// ============================================================================
+
+namespace {
+
+constexpr uint32_t STM_STORAGE = std::numeric_limits<uint32_t>::max();
+
+struct StmVersion {
+    uint32_t txn;           // STM_STORAGE: batch öncesi bakiye
+    uint32_t incarnation;
+    
+    bool operator==(const StmVersion& other) const {
+        return txn == other.txn && incarnation == other.incarnation;
+    }
+};
+
+struct StmRead {
+    uint32_t account;
+    StmVersion version;
+};
+
+// Bir transfer en fazla iki hesap okur ve yazar: kümeler yığında, tx başına
+// tahsis yok
+template <typename T>
+struct StmPair {
+    std::array<T, 2> items;
+    uint8_t count = 0;
+    
+    void push(const T& item) { items[count++] = item; }
+    const T* begin() const { return items.data(); }
+    const T* end() const { return items.data() + count; }
+    bool contains(const T& item) const { return std::find(begin(), end(), item) != end(); }
+};
+
+struct StmReadResult {
+    bool dependency;        // okunan sürüm ESTIMATE: yazarı yeniden yürütülüyor
+    uint32_t blocking;
+    StmVersion version;
+    uint64_t value;
+};
+
+// Kritik bölümler birkaç karşılaştırma sürer; std::mutex hesap başına 40 bayt
+class StmSpinLock {
+private:
+    std::atomic_flag flag = ATOMIC_FLAG_INIT;
+    
+public:
+    void lock() {
+        while (flag.test_and_set(std::memory_order_acquire)) {
+            std::this_thread::yield();
+        }
+    }
+    void unlock() { flag.clear(std::memory_order_release); }
+};
+
+// Hesap başına tx indeksine göre sıralı sürümler. Okuyucu kendi indeksinden
+// küçük en büyük sürümü görür; yoksa batch öncesi bakiyeyi. Hesapların çoğu
+// batch'te bir iki kez yazılır: sıralı küçük vektör, ağaç düğümü tahsisi yok.
+class MultiVersionMemory {
+private:
+    struct Entry {
+        uint32_t txn;
+        uint32_t incarnation;
+        uint64_t value;
+        bool estimate;
+    };
+    
+    struct Account {
+        StmSpinLock lock;
+        std::vector<Entry> versions;
+        
+        // txn'den küçük olmayan ilk sürüm
+        std::vector<Entry>::iterator lower_bound(uint32_t txn) {
+            return std::lower_bound(versions.begin(), versions.end(), txn,
+                [](const Entry& e, uint32_t t) { return e.txn < t; });
+        }
+        
+        Entry* find(uint32_t txn) {
+            auto it = lower_bound(txn);
+            return it != versions.end() && it->txn == txn ? &*it : nullptr;
+        }
+    };
+    
+    // Son yürütmenin okuma kümesi ve yazdığı hesaplar (doğrulayıcılar okur)
+    struct TxnSets {
+        StmSpinLock lock;
+        StmPair<StmRead> reads;
+        StmPair<uint32_t> writes;
+        bool applied = false;
+    };
+    
+    const std::vector<uint64_t>& base;
+    std::unique_ptr<Account[]> accounts;
+    std::unique_ptr<TxnSets[]> txns;
+    
+public:
+    MultiVersionMemory(const std::vector<uint64_t>& base_balances, size_t txn_count)
+        : base(base_balances),
+          accounts(new Account[base_balances.size()]),
+          txns(new TxnSets[txn_count]) {}
+    
+    StmReadResult read(uint32_t account, uint32_t txn) {
+        Account& a = accounts[account];
+        std::lock_guard<StmSpinLock> lock(a.lock);
+        
+        auto it = a.lower_bound(txn);
+        if (it == a.versions.begin()) {
+            return StmReadResult{false, 0, StmVersion{STM_STORAGE, 0}, base[account]};
+        }
+        --it;
+        
+        if (it->estimate) {
+            return StmReadResult{true, it->txn, StmVersion{it->txn, it->incarnation}, 0};
+        }
+        return StmReadResult{false, 0, StmVersion{it->txn, it->incarnation}, it->value};
+    }
+    
+    // Yazma kümesini yayınlar; önceki yürütmede olmayan bir hesaba yazıldıysa true
+    bool record(uint32_t txn, uint32_t incarnation, const StmPair<StmRead>& reads,
+                const StmPair<std::pair<uint32_t, uint64_t>>& writes, bool applied) {
+        StmPair<uint32_t> written;
+        for (const auto& [account, value] : writes) {
+            Account& a = accounts[account];
+            std::lock_guard<StmSpinLock> lock(a.lock);
+            auto it = a.lower_bound(txn);
+            if (it != a.versions.end() && it->txn == txn) {
+                *it = Entry{txn, incarnation, value, false};
+            } else {
+                a.versions.insert(it, Entry{txn, incarnation, value, false});
+            }
+            written.push(account);
+        }
+        
+        auto& sets = txns[txn];
+        std::lock_guard<StmSpinLock> lock(sets.lock);
+        
+        bool wrote_new_location = false;
+        for (uint32_t account : written) {
+            if (!sets.writes.contains(account)) {
+                wrote_new_location = true;
+            }
+        }
+        
+        // Bu yürütmede artık yazılmayan hesaplardaki eski sürümler silinir
+        for (uint32_t account : sets.writes) {
+            if (!written.contains(account)) {
+                Account& a = accounts[account];
+                std::lock_guard<StmSpinLock> account_lock(a.lock);
+                auto it = a.lower_bound(txn);
+                if (it != a.versions.end() && it->txn == txn) {
+                    a.versions.erase(it);
+                }
+            }
+        }
+        
+        sets.reads = reads;
+        sets.writes = written;
+        sets.applied = applied;
+        return wrote_new_location;
+    }
+    
+    bool validate(uint32_t txn) {
+        StmPair<StmRead> reads;
+        {
+            std::lock_guard<StmSpinLock> lock(txns[txn].lock);
+            reads = txns[txn].reads;
+        }
+        
+        for (const auto& r : reads) {
+            StmReadResult current = read(r.account, txn);
+            if (current.dependency || !(current.version == r.version)) {
+                return false;
+            }
+        }
+        return true;
+    }
+    
+    void mark_estimates(uint32_t txn) {
+        StmPair<uint32_t> written;
+        {
+            std::lock_guard<StmSpinLock> lock(txns[txn].lock);
+            written = txns[txn].writes;
+        }
+        
+        for (uint32_t account : written) {
+            Account& a = accounts[account];
+            std::lock_guard<StmSpinLock> lock(a.lock);
+            if (Entry* e = a.find(txn)) {
+                e->estimate = true;
+            }
+        }
+    }
+    
+    // Yürütme bittikten sonra (tek thread) çağrılır
+    uint64_t final_value(uint32_t account) const {
+        const auto& versions = accounts[account].versions;
+        return versions.empty() ? base[account] : versions.back().value;
+    }
+    
+    bool touched(uint32_t account) const { return !accounts[account].versions.empty(); }
+    bool applied(uint32_t txn) const { return txns[txn].applied; }
+};
+
+enum class StmTaskKind : uint8_t {
+    NONE,
+    EXECUTE,
+    VALIDATE
+};
+
+struct StmTask {
+    StmTaskKind kind;
+    uint32_t txn;
+    uint32_t incarnation;
+};
+
+// Block-STM iş planlayıcısı: yürütme ve doğrulama indeksleri batch sırasında
+// ilerler, abort/yeniden yürütme indeksleri geri çeker.
+class StmScheduler {
+private:
+    enum class Status : uint8_t {
+        READY_TO_EXECUTE,
+        EXECUTING,
+        EXECUTED,
+        ABORTING
+    };
+    
+    struct TxnState {
+        std::mutex mutex;
+        uint32_t incarnation = 0;
+        Status status = Status::READY_TO_EXECUTE;
+        std::vector<uint32_t> dependents;   // bu tx'in yazmasını bekleyenler
+    };
+    
+    const uint32_t txn_count;
+    std::unique_ptr<TxnState[]> states;
+    std::atomic<uint32_t> execution_idx;
+    std::atomic<uint32_t> validation_idx;
+    std::atomic<uint64_t> decrease_cnt;
+    std::atomic<int64_t> num_active_tasks;
+    std::atomic<bool> done_marker;
+    
+    static void fetch_min(std::atomic<uint32_t>& target, uint32_t value) {
+        uint32_t current = target.load();
+        while (value < current && !target.compare_exchange_weak(current, value)) {
+        }
+    }
+    
+    void decrease_execution_idx(uint32_t target) {
+        fetch_min(execution_idx, target);
+        decrease_cnt.fetch_add(1);
+    }
+    
+    void decrease_validation_idx(uint32_t target) {
+        fetch_min(validation_idx, target);
+        decrease_cnt.fetch_add(1);
+    }
+    
+    void check_done() {
+        uint64_t observed = decrease_cnt.load();
+        if (std::min(execution_idx.load(), validation_idx.load()) >= txn_count &&
+            num_active_tasks.load() == 0 && observed == decrease_cnt.load()) {
+            done_marker.store(true);
+        }
+    }
+    
+    StmTask try_incarnate(uint32_t txn) {
+        if (txn < txn_count) {
+            std::lock_guard<std::mutex> lock(states[txn].mutex);
+            if (states[txn].status == Status::READY_TO_EXECUTE) {
+                states[txn].status = Status::EXECUTING;
+                return StmTask{StmTaskKind::EXECUTE, txn, states[txn].incarnation};
+            }
+        }
+        num_active_tasks.fetch_sub(1);
+        return StmTask{StmTaskKind::NONE, 0, 0};
+    }
+    
+    StmTask next_version_to_execute() {
+        if (execution_idx.load() >= txn_count) {
+            check_done();
+            return StmTask{StmTaskKind::NONE, 0, 0};
+        }
+        num_active_tasks.fetch_add(1);
+        return try_incarnate(execution_idx.fetch_add(1));
+    }
+    
+    StmTask next_version_to_validate() {
+        if (validation_idx.load() >= txn_count) {
+            check_done();
+            return StmTask{StmTaskKind::NONE, 0, 0};
+        }
+        num_active_tasks.fetch_add(1);
+        uint32_t txn = validation_idx.fetch_add(1);
+        
+        if (txn < txn_count) {
+            std::lock_guard<std::mutex> lock(states[txn].mutex);
+            if (states[txn].status == Status::EXECUTED) {
+                return StmTask{StmTaskKind::VALIDATE, txn, states[txn].incarnation};
+            }
+        }
+        num_active_tasks.fetch_sub(1);
+        return StmTask{StmTaskKind::NONE, 0, 0};
+    }
+    
+    void set_ready_status(uint32_t txn) {
+        std::lock_guard<std::mutex> lock(states[txn].mutex);
+        states[txn].incarnation++;
+        states[txn].status = Status::READY_TO_EXECUTE;
+    }
+    
+public:
+    explicit StmScheduler(uint32_t count)
+        : txn_count(count), states(new TxnState[count]), execution_idx(0), validation_idx(0),
+          decrease_cnt(0), num_active_tasks(0), done_marker(count == 0) {}
+    
+    bool done() const { return done_marker.load(); }
+    
+    StmTask next_task() {
+        if (validation_idx.load() < execution_idx.load()) {
+            StmTask task = next_version_to_validate();
+            if (task.kind != StmTaskKind::NONE) {
+                return task;
+            }
+        } else {
+            StmTask task = next_version_to_execute();
+            if (task.kind != StmTaskKind::NONE) {
+                return task;
+            }
+        }
+        return StmTask{StmTaskKind::NONE, 0, 0};
+    }
+    
+    // txn, blocking'in yazmasını bekler; blocking zaten bittiyse false (hemen tekrar dene)
+    bool add_dependency(uint32_t txn, uint32_t blocking) {
+        // blocking < txn: kilit sırası her zaman küçük indeksten büyüğe
+        std::lock_guard<std::mutex> blocking_lock(states[blocking].mutex);
+        if (states[blocking].status == Status::EXECUTED) {
+            return false;
+        }
+        
+        {
+            std::lock_guard<std::mutex> lock(states[txn].mutex);
+            states[txn].status = Status::ABORTING;
+        }
+        states[blocking].dependents.push_back(txn);
+        num_active_tasks.fetch_sub(1);
+        return true;
+    }
+    
+    StmTask finish_execution(uint32_t txn, uint32_t incarnation, bool wrote_new_location) {
+        std::vector<uint32_t> dependents;
+        {
+            std::lock_guard<std::mutex> lock(states[txn].mutex);
+            states[txn].status = Status::EXECUTED;
+            dependents.swap(states[txn].dependents);
+        }
+        
+        if (!dependents.empty()) {
+            uint32_t min_dependent = txn_count;
+            for (uint32_t d : dependents) {
+                set_ready_status(d);
+                min_dependent = std::min(min_dependent, d);
+            }
+            decrease_execution_idx(min_dependent);
+        }
+        
+        if (validation_idx.load() > txn) {
+            if (wrote_new_location) {
+                // Yeni yazılan hesap, sonraki tx'lerin okumalarını geçersiz kılabilir
+                decrease_validation_idx(txn);
+            } else {
+                return StmTask{StmTaskKind::VALIDATE, txn, incarnation};
+            }
+        }
+        
+        num_active_tasks.fetch_sub(1);
+        return StmTask{StmTaskKind::NONE, 0, 0};
+    }
+    
+    bool try_validation_abort(uint32_t txn, uint32_t incarnation) {
+        std::lock_guard<std::mutex> lock(states[txn].mutex);
+        if (states[txn].incarnation == incarnation && states[txn].status == Status::EXECUTED) {
+            states[txn].status = Status::ABORTING;
+            return true;
+        }
+        return false;
+    }
+    
+    StmTask finish_validation(uint32_t txn, bool aborted) {
+        if (aborted) {
+            set_ready_status(txn);
+            decrease_validation_idx(txn + 1);
+            if (execution_idx.load() > txn) {
+                // Doğrulama görevi yeniden yürütmeye dönüşür; başarısızsa
+                // try_incarnate aktif görev sayısını kendisi düşürür
+                return try_incarnate(txn);
+            }
+        }
+        
+        num_active_tasks.fetch_sub(1);
+        return StmTask{StmTaskKind::NONE, 0, 0};
+    }
+};
+
+// Batch'in hesapları yoğun indekslere çevrilmiş hali
+struct StmTransfer {
+    uint32_t from;
+    uint32_t to;
+    uint64_t amount;
+    uint64_t fee;
+    bool replay;            // tekrar penceresinde ya da batch'te daha önce var
+};
+
+// Transfer semantiği (route_transaction ile aynı kurallar): bakiye yetmezse ya
+// da alıcı bakiyesi taşarsa tx reddedilir; ücret yakılır.
+struct StmExecution {
+    bool dependency;
+    uint32_t blocking;
+    bool applied;
+    StmPair<StmRead> reads;
+    StmPair<std::pair<uint32_t, uint64_t>> writes;
+};
+
+StmExecution stm_execute(MultiVersionMemory& memory, const StmTransfer& t, uint32_t txn) {
+    StmExecution out{false, 0, false, {}, {}};
+    if (t.replay) {
+        return out;
+    }
+    
+    StmReadResult from = memory.read(t.from, txn);
+    if (from.dependency) {
+        out.dependency = true;
+        out.blocking = from.blocking;
+        return out;
+    }
+    out.reads.push(StmRead{t.from, from.version});
+    
+    if (from.value < t.amount + t.fee) {
+        return out;
+    }
+    
+    if (t.from == t.to) {
+        out.writes.push({t.from, from.value - t.fee});
+        out.applied = true;
+        return out;
+    }
+    
+    StmReadResult to = memory.read(t.to, txn);
+    if (to.dependency) {
+        out.dependency = true;
+        out.blocking = to.blocking;
+        return out;
+    }
+    out.reads.push(StmRead{t.to, to.version});
+    
+    if (to.value > std::numeric_limits<uint64_t>::max() - t.amount) {
+        return out;
+    }
+    
+    out.writes.push({t.from, from.value - t.amount - t.fee});
+    out.writes.push({t.to, to.value + t.amount});
+    out.applied = true;
+    return out;
+}
+
+void stm_worker(StmScheduler& scheduler, MultiVersionMemory& memory,
+                const std::vector<StmTransfer>& transfers) {
+    StmTask task{StmTaskKind::NONE, 0, 0};
+    
+    while (!scheduler.done()) {
+        if (task.kind == StmTaskKind::EXECUTE) {
+            StmExecution exec = stm_execute(memory, transfers[task.txn], task.txn);
+            
+            if (exec.dependency) {
+                // Bekleme kaydı başarısızsa (blocking bitti) aynı sürümü tekrar yürüt
+                if (!scheduler.add_dependency(task.txn, exec.blocking)) {
+                    continue;
+                }
+                task = StmTask{StmTaskKind::NONE, 0, 0};
+            } else {
+                bool wrote_new = memory.record(task.txn, task.incarnation, exec.reads,
+                                               exec.writes, exec.applied);
+                task = scheduler.finish_execution(task.txn, task.incarnation, wrote_new);
+            }
+        } else if (task.kind == StmTaskKind::VALIDATE) {
+            bool valid = memory.validate(task.txn);
+            bool aborted = !valid && scheduler.try_validation_abort(task.txn, task.incarnation);
+            if (aborted) {
+                memory.mark_estimates(task.txn);
+            }
+            task = scheduler.finish_validation(task.txn, aborted);
+        }
+        
+        if (task.kind == StmTaskKind::NONE) {
+            task = scheduler.next_task();
+            if (task.kind == StmTaskKind::NONE) {
+                std::this_thread::yield();
+            }
+        }
+    }
+}
+
+} // namespace
+
+BatchExecutionResult BatchExecutor::execute_optimistic(const std::vector<Transaction>& batch) {
+    BatchExecutionResult result;
+    result.applied.assign(batch.size(), 0);
+    
+    if (batch.empty()) {
+        return result;
+    }
+    
+    // Hesapları yoğun indekslere çevir ve batch öncesi bakiyeleri bir kez oku
+    FlatMap<Address, uint32_t, AddressHash> index_of;
+    std::vector<Address> addresses;
+    std::vector<StmTransfer> transfers(batch.size());
+    std::vector<uint32_t> last_writer;
+    size_t conflicts = 0;
+    
+    auto intern = [&](const Address& addr) -> uint32_t {
+        auto it = index_of.find(addr);
+        if (it != index_of.end()) {
+            return it->second;
+        }
+        uint32_t id = static_cast<uint32_t>(addresses.size());
+        index_of[addr] = id;
+        addresses.push_back(addr);
+        last_writer.push_back(STM_STORAGE);
+        return id;
+    };
+    
+    // Tekrarlar spekülasyondan önce elenir: okuma kümesi olmadığı için
+    // doğrulamada hiçbir tx'e bağımlılık yaratmazlar. Batch içinde aynı hash
+    // tekrar ederse yalnızca ilk kopya yürütülür. Pencere sorgusu shard başına
+    // tek kilitle yapılır.
+    QuantumCrypto crypto;
+    std::vector<Hash256> hashes(batch.size());
+    std::vector<Address> senders(batch.size());
+    for (size_t i = 0; i < batch.size(); ++i) {
+        hashes[i] = batch[i].compute_hash(crypto);
+        senders[i] = batch[i].from;
+    }
+    std::vector<uint8_t> seen;
+    sharding.recently_applied(senders, hashes, seen);
+    
+    FlatMap<Hash256, uint8_t, DigestHash> in_batch;
+    for (size_t i = 0; i < batch.size(); ++i) {
+        bool replay = seen[i] || in_batch.count(hashes[i]) > 0;
+        in_batch[hashes[i]] = 1;
+        
+        uint32_t from = intern(batch[i].from);
+        uint32_t to = intern(batch[i].to);
+        transfers[i] = StmTransfer{from, to, batch[i].amount, batch[i].fee, replay};
+        
+        // Yakın geçmişte yazılmış hesaba dokunan tx spekülasyonda büyük
+        // olasılıkla yeniden yürütülür
+        uint32_t txn = static_cast<uint32_t>(i);
+        bool conflict = false;
+        for (uint32_t account : {from, to}) {
+            if (last_writer[account] != STM_STORAGE && txn - last_writer[account] <= STM_CONFLICT_WINDOW) {
+                conflict = true;
+            }
+            last_writer[account] = txn;
+        }
+        conflicts += conflict ? 1 : 0;
+    }
+    
+    std::vector<uint64_t> base;
+    sharding.balances_of(addresses, base);
+    
+    // Tek worker'da, küçük ya da çakışması yüksek batch'te spekülasyon yalnızca
+    // ek yük getirir: stm_execute'un kurallarıyla sırayla yürütülür (sonuç aynı)
+    bool serial = worker_count() == 1 || batch.size() < STM_MIN_PARALLEL_BATCH ||
+                  conflicts * STM_MAX_CONFLICT_DENOMINATOR > batch.size();
+    
+    std::vector<uint64_t> final_balance;
+    std::vector<uint8_t> touched;
+    
+    if (serial) {
+        final_balance = base;
+        touched.assign(addresses.size(), 0);
+        
+        for (size_t i = 0; i < batch.size(); ++i) {
+            const StmTransfer& t = transfers[i];
+            uint64_t from = final_balance[t.from];
+            if (t.replay || from < t.amount + t.fee) {
+                continue;
+            }
+            
+            if (t.from == t.to) {
+                final_balance[t.from] = from - t.fee;
+            } else {
+                uint64_t to = final_balance[t.to];
+                if (to > std::numeric_limits<uint64_t>::max() - t.amount) {
+                    continue;
+                }
+                final_balance[t.from] = from - t.amount - t.fee;
+                final_balance[t.to] = to + t.amount;
+                touched[t.to] = 1;
+            }
+            touched[t.from] = 1;
+            result.applied[i] = 1;
+        }
+    } else {
+        MultiVersionMemory memory(base, batch.size());
+        StmScheduler scheduler(static_cast<uint32_t>(batch.size()));
+        
+        // Her worker planlayıcı bitene kadar görev çeker
+        run_parallel(worker_count(), [&](size_t) {
+            stm_worker(scheduler, memory, transfers);
+        });
+        
+        final_balance.resize(addresses.size());
+        touched.resize(addresses.size());
+        for (uint32_t a = 0; a < addresses.size(); ++a) {
+            touched[a] = memory.touched(a) ? 1 : 0;
+            final_balance[a] = memory.final_value(a);
+        }
+        for (size_t i = 0; i < batch.size(); ++i) {
+            result.applied[i] = memory.applied(static_cast<uint32_t>(i)) ? 1 : 0;
+        }
+    }
+    
+    // Yalnızca değişen hesaplar yazılır; shard'lar birbirinden bağımsız paralel
+    std::vector<std::vector<std::pair<Address, uint64_t>>> per_shard(SHARD_COUNT);
+    for (uint32_t a = 0; a < addresses.size(); ++a) {
+        if (touched[a]) {
+            per_shard[sharding.shard_of(addresses[a])].emplace_back(addresses[a], final_balance[a]);
+        }
+    }
+    run_parallel(SHARD_COUNT, [&](size_t shard) {
+        sharding.commit_balances(per_shard[shard]);
+    });
+    
+    // Tekrar penceresi, telemetri sayaçları ve sketch: shard başına tek kilit
+    std::vector<uint8_t> replay(batch.size());
+    for (size_t i = 0; i < batch.size(); ++i) {
+        replay[i] = transfers[i].replay ? 1 : 0;
+        if (!result.applied[i]) {
+            continue;
+        }
+        ++result.applied_count;
+        if (sharding.shard_of(batch[i].from) != sharding.shard_of(batch[i].to)) {
+            ++result.cross_shard_count;
+        }
+    }
+    sharding.record_applied(batch, hashes, result.applied, replay);
+    result.rejected_count = batch.size() - result.applied_count;
+    
+    return result;
+}
+
+// ============================================================================
+// SHARD-PER-CORE AKTÖR YÜRÜTME İMPLEMENTASYONU
+// ============================================================================
+
+namespace {
+
+enum ActorCommandKind : uint8_t {
+    CMD_ADOPT = 0,      // shard bu worker'a geçti: tabloyu yerel bellekte kur
+    CMD_WORK = 1,       // shard'ın bu batch'teki tx'leri (batch sırasıyla)
+    CMD_END_BATCH = 2,  // faz 1 bitti: kredi ve iade fazlarına geç
+    CMD_STOP = 3
+};
+
+struct ActorCommand {
+    uint8_t kind;
+    uint32_t shard_id;
+    const std::vector<uint32_t>* indices;
+};
+
+enum ActorMessageKind : uint8_t {
+    ACTOR_CREDIT = 0,
+    ACTOR_REFUND = 1,
+    ACTOR_DONE = 2      // gönderenin bu fazdaki son mesajı
+};
+
+struct ActorMessage {
+    uint8_t kind;
+    uint32_t from_shard;
+    uint32_t to_shard;
+    uint64_t sequence;
+    uint64_t tag;
+    Address from;
+    Address to;
+    uint64_t amount;
+    uint64_t fee;
+};
+
+constexpr size_t ACTOR_COMMAND_CAPACITY = 4 * SHARD_COUNT;
+constexpr size_t ACTOR_RING_CAPACITY = 4096;
+
+// Hedef shard'da (kaynak, sequence) sırası: BatchExecutor'ın teslim sırası
+bool actor_message_less(const ActorMessage& a, const ActorMessage& b) {
+    if (a.to_shard != b.to_shard) {
+        return a.to_shard < b.to_shard;
+    }
+    return a.from_shard != b.from_shard ? a.from_shard < b.from_shard : a.sequence < b.sequence;
+}
+
+} // namespace
+
+struct ShardActorRuntime::Worker {
+    std::thread thread;
+    SpscRing<ActorCommand> commands;
+    std::mutex park_mutex;
+    std::condition_variable park_cv;
+    
+    // inbox[p]: worker p -> bu worker. Halka doluysa mesaj gönderenin
+    // backlog'unda bekler; hiçbir taraf bloklanmadığı için kilitlenme olmaz.
+    std::vector<std::unique_ptr<SpscRing<ActorMessage>>> inbox;
+    std::vector<std::deque<ActorMessage>> backlog;
+    
+    // Batch durumu (yalnızca bu worker yazar)
+    std::vector<ActorMessage> local;        // kendine giden kredi/iadeler
+    std::vector<uint64_t> rolled_back;
+    std::vector<std::pair<uint32_t, uint64_t>> load;
+    size_t cross;
+    
+    Worker(size_t worker_count)
+        : commands(ACTOR_COMMAND_CAPACITY), backlog(worker_count), cross(0) {
+        for (size_t p = 0; p < worker_count; ++p) {
+            inbox.push_back(std::make_unique<SpscRing<ActorMessage>>(ACTOR_RING_CAPACITY));
+        }
+    }
+};
+
+ShardActorRuntime::ShardActorRuntime(FractalSharding& sharding, size_t worker_count, bool pin_threads)
+    : sharding(sharding), pinned(0), batch(nullptr), result(nullptr), finished(0) {
+    if (worker_count == 0) {
+        worker_count = std::max(1u, std::thread::hardware_concurrency());
+    }
+    owner.fill(0);
+    home.fill(-1);
+    
+    for (size_t i = 0; i < worker_count; ++i) {
+        workers.push_back(std::make_unique<Worker>(worker_count));
+    }
+    
+    unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+    for (size_t i = 0; i < worker_count; ++i) {
+        workers[i]->thread = std::thread(&ShardActorRuntime::worker_loop, this, i);
+        
+#if defined(__linux__)
+        if (pin_threads) {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(i % cores, &set);
+            if (pthread_setaffinity_np(workers[i]->thread.native_handle(), sizeof(set), &set) == 0) {
+                ++pinned;
+            }
+        }
+#else
+        (void)pin_threads;
+        (void)cores;
+#endif
+    }
+}
+
+ShardActorRuntime::~ShardActorRuntime() {
+    for (auto& worker : workers) {
+        while (!worker->commands.try_push(ActorCommand{CMD_STOP, 0, nullptr})) {
+            std::this_thread::yield();
+        }
+        std::lock_guard<std::mutex> lock(worker->park_mutex);
+        worker->park_cv.notify_one();
+    }
+    for (auto& worker : workers) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+    }
+}
+
+void ShardActorRuntime::worker_loop(size_t index) {
+    Worker& self = *workers[index];
+    
+    while (true) {
+        ActorCommand cmd;
+        if (!self.commands.try_pop(cmd)) {
+            // Kuyruk boş: batch sınırında uyu (tx başına değil, batch başına bir kez)
+            std::unique_lock<std::mutex> lock(self.park_mutex);
+            self.park_cv.wait(lock, [&self]() { return !self.commands.empty(); });
+            continue;
+        }
+        
+        switch (cmd.kind) {
+            case CMD_ADOPT: {
+                // First-touch: tablo bu thread'de kopyalanıp taşınır
+                auto& shard = *sharding.shards[cmd.shard_id];
+                AccountMap local_copy(shard.balances);
+                shard.balances = std::move(local_copy);
+                break;
+            }
+            case CMD_WORK:
+                run_shard(index, cmd.shard_id, *cmd.indices);
+                break;
+            case CMD_END_BATCH:
+                finish_batch(index);
+                break;
+            case CMD_STOP:
+                return;
+        }
+    }
+}
+
+void ShardActorRuntime::run_shard(size_t index, uint32_t shard_id, const std::vector<uint32_t>& indices) {
+    Worker& self = *workers[index];
+    auto& shard = *sharding.shards[shard_id];
+    QuantumCrypto crypto;
+    
+    for (uint32_t idx : indices) {
+        const Transaction& tx = (*batch)[idx];
+        uint32_t to_shard = sharding.assign_shard(tx.to);
+        bool ok;
+        
+        if (to_shard == shard_id) {
+            ok = sharding.apply_local(shard_id, tx);
+        } else {
+            ok = sharding.debit_sender(shard_id, tx, tx.compute_hash(crypto));
+            if (ok && !sharding.credit_hot(shard_id, tx.to, tx.amount)) {
+                ActorMessage msg;
+                msg.kind = ACTOR_CREDIT;
+                msg.from_shard = shard_id;
+                msg.to_shard = to_shard;
+                msg.sequence = shard.next_outbound_sequence++;
+                msg.tag = static_cast<uint64_t>(idx) + 1;
+                msg.from = tx.from;
+                msg.to = tx.to;
+                msg.amount = tx.amount;
+                msg.fee = tx.fee;
+                
+                size_t target = owner[to_shard];
+                if (target == index) {
+                    self.local.push_back(msg);
+                } else if (!self.backlog[target].empty() || !workers[target]->inbox[index]->try_push(msg)) {
+                    self.backlog[target].push_back(msg);
+                }
+            }
+            self.cross += ok ? 1 : 0;
+        }
+        
+        (*result).applied[idx] = ok ? 1 : 0;
+    }
+    
+    self.load.emplace_back(shard_id, indices.size());
+}
+
+void ShardActorRuntime::finish_batch(size_t index) {
+    Worker& self = *workers[index];
+    const size_t n = workers.size();
+    
+    auto flush_backlog = [&]() {
+        bool pending = false;
+        for (size_t p = 0; p < n; ++p) {
+            auto& queue = self.backlog[p];
+            while (!queue.empty() && workers[p]->inbox[index]->try_push(queue.front())) {
+                queue.pop_front();
+            }
+            pending = pending || !queue.empty();
+        }
+        return pending;
+    };
+    
+    auto send = [&](size_t target, const ActorMessage& msg) {
+        if (target == index) {
+            self.local.push_back(msg);
+        } else if (!self.backlog[target].empty() || !workers[target]->inbox[index]->try_push(msg)) {
+            self.backlog[target].push_back(msg);
+        }
+    };
+    
+    // Her eşe bu fazın bitişini bildir, eşlerin mesajlarını DONE gelene kadar topla
+    auto exchange = [&]() {
+        ActorMessage done{};
+        done.kind = ACTOR_DONE;
+        for (size_t p = 0; p < n; ++p) {
+            if (p != index) {
+                send(p, done);
+            }
+        }
+        
+        std::vector<ActorMessage> received;
+        received.swap(self.local);
+        std::vector<uint8_t> peer_done(n, 0);
+        peer_done[index] = 1;
+        size_t remaining = n - 1;
+        
+        while (remaining > 0) {
+            flush_backlog();
+            bool progress = false;
+            for (size_t p = 0; p < n; ++p) {
+                ActorMessage msg;
+                while (!peer_done[p] && self.inbox[p]->try_pop(msg)) {
+                    progress = true;
+                    if (msg.kind == ACTOR_DONE) {
+                        peer_done[p] = 1;
+                        --remaining;
+                    } else {
+                        received.push_back(msg);
+                    }
+                }
+            }
+            if (!progress) {
+                std::this_thread::yield();
+            }
+        }
+        
+        std::sort(received.begin(), received.end(), actor_message_less);
+        return received;
+    };
+    
+    // Faz 2: sahip olunan hedef shard'lara krediler
+    std::vector<ActorMessage> credits = exchange();
+    for (const auto& msg : credits) {
+        if (!sharding.apply_credit(msg.to_shard, msg.to, msg.amount)) {
+            ActorMessage refund = msg;
+            refund.kind = ACTOR_REFUND;
+            refund.to_shard = msg.from_shard;   // iade sırası kaynak shard'a göre
+            send(owner[msg.from_shard], refund);
+        }
+    }
+    // Hedef shard başına bu batch'te gelen kredi: yük ve kuyruk derinliği
+    for (size_t begin = 0, end = 0; begin < credits.size(); begin = end) {
+        uint32_t to_shard = credits[begin].to_shard;
+        while (end < credits.size() && credits[end].to_shard == to_shard) {
+            ++end;
+        }
+        self.load.emplace_back(to_shard, end - begin);
+        sharding.shards[to_shard]->counters.note_queue_depth(end - begin);
+    }
+    
+    // Faz 3: reddedilen kredilerin borcu kaynakta iade edilir
+    std::vector<ActorMessage> refunds = exchange();
+    QuantumCrypto crypto;
+    for (const auto& msg : refunds) {
+        // Nadir yol: hash mesajda taşınmaz, batch'ten yeniden hesaplanır
+        Hash256 tx_hash = (*batch)[msg.tag - 1].compute_hash(crypto);
+        sharding.refund_sender(msg.from_shard, msg.from, msg.amount + msg.fee, tx_hash);
+        self.rolled_back.push_back(msg.tag);
+    }
+    
+    while (flush_backlog()) {
+        std::this_thread::yield();
+    }
+    
+    std::lock_guard<std::mutex> lock(done_mutex);
+    ++finished;
+    done_cv.notify_one();
+}
+
+BatchExecutionResult ShardActorRuntime::execute(const std::vector<Transaction>& txs) {
+    BatchExecutionResult out;
+    out.applied.assign(txs.size(), 0);
+    
+    // Sahiplik: aktif shard'lar worker'lara sırayla dağıtılır
+    size_t next = 0;
+    for (uint32_t i = 0; i < SHARD_COUNT; ++i) {
+        if (sharding.regions[i].active) {
+            owner[i] = static_cast<uint32_t>(next++ % workers.size());
+        }
+    }
+    
+    std::vector<std::vector<uint32_t>> per_shard(SHARD_COUNT);
+    for (uint32_t i = 0; i < txs.size(); ++i) {
+        per_shard[sharding.assign_shard(txs[i].from)].push_back(i);
+    }
+    
+    batch = &txs;
+    result = &out;
+    finished = 0;
+    
+    for (auto& worker : workers) {
+        worker->cross = 0;
+        worker->load.clear();
+        worker->rolled_back.clear();
+    }
+    
+    auto dispatch = [this](size_t target, const ActorCommand& cmd) {
+        while (!workers[target]->commands.try_push(cmd)) {
+            std::this_thread::yield();
+        }
+    };
+    
+    for (uint32_t i = 0; i < SHARD_COUNT; ++i) {
+        if (sharding.regions[i].active && home[i] != static_cast<int32_t>(owner[i])) {
+            dispatch(owner[i], ActorCommand{CMD_ADOPT, i, nullptr});
+            home[i] = static_cast<int32_t>(owner[i]);
+        }
+    }
+    for (uint32_t i = 0; i < SHARD_COUNT; ++i) {
+        if (!per_shard[i].empty()) {
+            dispatch(owner[i], ActorCommand{CMD_WORK, i, &per_shard[i]});
+        }
+    }
+    for (size_t w = 0; w < workers.size(); ++w) {
+        dispatch(w, ActorCommand{CMD_END_BATCH, 0, nullptr});
+        std::lock_guard<std::mutex> lock(workers[w]->park_mutex);
+        workers[w]->park_cv.notify_one();
+    }
+    
+    {
+        std::unique_lock<std::mutex> lock(done_mutex);
+        done_cv.wait(lock, [this]() { return finished == workers.size(); });
+    }
+    
+    // Sonuçlar: yük sayaçları shard başına bir kez, iadeler etiketle
+    for (auto& worker : workers) {
+        for (const auto& [shard_id, count] : worker->load) {
+            sharding.shard_load[shard_id].fetch_add(count, std::memory_order_relaxed);
+        }
+        for (uint64_t tag : worker->rolled_back) {
+            if (tag > 0 && tag <= txs.size() && out.applied[tag - 1]) {
+                out.applied[tag - 1] = 0;
+                ++out.rolled_back_count;
+            }
+        }
+        out.cross_shard_count += worker->cross;
+    }
+    
+    sharding.flush_credit_deltas();
+    
+    for (uint8_t ok : out.applied) {
+        out.applied_count += ok;
+    }
+    out.rejected_count = txs.size() - out.applied_count;
+    
+    batch = nullptr;
+    result = nullptr;
+    return out;
+}
+
+// ============================================================================
+// WRITE-AHEAD LOG İMPLEMENTASYONU
+// ============================================================================
+
+namespace {
+
+constexpr uint32_t WAL_RECORD_MAGIC = 0x314C5748;   // "HWL1"
+constexpr uint32_t CHECKPOINT_MAGIC = 0x31504348;   // "HCP1"
+constexpr size_t WAL_ENTRY_SIZE = 20 + 8;
+constexpr size_t WAL_HEADER_SIZE = 4 + 4;           // magic, payload uzunluğu
+
+// CRC-32C (Castagnoli); SSE4.2 ile derlendiyse donanım komutu
+uint32_t crc32c(const uint8_t* data, size_t len) {
+    uint32_t crc = 0xFFFFFFFFu;
+#if defined(__SSE4_2__)
+    while (len >= 8) {
+        uint64_t word;
+        std::memcpy(&word, data, 8);
+        crc = static_cast<uint32_t>(_mm_crc32_u64(crc, word));
+        data += 8;
+        len -= 8;
+    }
+    while (len > 0) {
+        crc = _mm_crc32_u8(crc, *data++);
+        --len;
+    }
+#else
+    static const std::array<uint32_t, 256> table = [] {
+        std::array<uint32_t, 256> t{};
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) {
+                c = (c & 1) ? (c >> 1) ^ 0x82F63B78u : c >> 1;
+            }
+            t[i] = c;
+        }
+        return t;
+    }();
+    while (len > 0) {
+        crc = table[(crc ^ *data++) & 0xFF] ^ (crc >> 8);
+        --len;
+    }
+#endif
+    return ~crc;
+}
+
+// Sayılar host bayt sırasıyla yazılır (log aynı makinede okunur)
+template <typename T>
+void put(std::vector<uint8_t>& out, T value) {
+    size_t at = out.size();
+    out.resize(at + sizeof(T));
+    std::memcpy(out.data() + at, &value, sizeof(T));
+}
+
+template <typename T>
+bool get(const std::vector<uint8_t>& in, size_t& at, T& value) {
+    if (at > in.size() || in.size() - at < sizeof(T)) {
+        return false;
+    }
+    std::memcpy(&value, in.data() + at, sizeof(T));
+    at += sizeof(T);
+    return true;
+}
+
+void put_entry(std::vector<uint8_t>& out, const Address& addr, uint64_t balance) {
+    out.insert(out.end(), addr.begin(), addr.end());
+    put(out, balance);
+}
+
+bool read_file(const std::string& path, std::vector<uint8_t>& data) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        return false;
+    }
+    data.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    return true;
+}
+
+// "<prefix><20 haneli yükseklik><suffix>" adlarını çözer
+bool parse_height(const std::string& name, const std::string& prefix, const std::string& suffix,
+                  uint64_t& height) {
+    if (name.size() != prefix.size() + 20 + suffix.size() ||
+        name.compare(0, prefix.size(), prefix) != 0 ||
+        name.compare(name.size() - suffix.size(), suffix.size(), suffix) != 0) {
+        return false;
+    }
+    height = 0;
+    for (size_t i = prefix.size(); i < prefix.size() + 20; ++i) {
+        if (name[i] < '0' || name[i] > '9') {
+            return false;
+        }
+        height = height * 10 + static_cast<uint64_t>(name[i] - '0');
+    }
+    return true;
+}
+
+// Checkpoint dosyasını doğrular; herhangi bir bölümün CRC'si tutmazsa false
+bool load_checkpoint(const std::string& path, uint64_t& height,
+                     std::vector<std::pair<Address, uint64_t>>& balances) {
+    std::vector<uint8_t> data;
+    if (!read_file(path, data)) {
+        return false;
+    }
+    
+    size_t at = 0;
+    uint32_t magic, shard_count, header_crc;
+    if (!get(data, at, magic) || magic != CHECKPOINT_MAGIC ||
+        !get(data, at, height) || !get(data, at, shard_count) ||
+        !get(data, at, header_crc) || header_crc != crc32c(data.data(), at - 4)) {
+        return false;
+    }
+    
+    balances.clear();
+    for (uint32_t s = 0; s < shard_count; ++s) {
+        size_t section = at;
+        uint32_t shard_id;
+        uint64_t count;
+        if (!get(data, at, shard_id) || !get(data, at, count) ||
+            count > (data.size() - at) / WAL_ENTRY_SIZE) {
+            return false;
+        }
+        
+        size_t entries = at;
+        at += count * WAL_ENTRY_SIZE;
+        uint32_t crc;
+        if (!get(data, at, crc) || crc != crc32c(data.data() + section, at - 4 - section)) {
+            return false;
+        }
+        
+        for (size_t e = entries; e < entries + count * WAL_ENTRY_SIZE; e += WAL_ENTRY_SIZE) {
+            Address addr;
+            uint64_t balance;
+            std::memcpy(addr.data(), data.data() + e, 20);
+            std::memcpy(&balance, data.data() + e + 20, 8);
+            balances.emplace_back(addr, balance);
+        }
+    }
+    return at == data.size();
+}
+
+} // namespace
+
+WriteAheadLog::WriteAheadLog(const DurabilityConfig& cfg)
+    : config(cfg), log_fd(-1), segment_base(0), last_height(0), last_checkpoint(0),
+      unsynced_batches(0), fsyncs(0), bytes(0) {
+    config.fsync_every_batches = std::max<uint32_t>(1, config.fsync_every_batches);
+    
+    std::error_code ec;
+    std::filesystem::create_directories(config.directory, ec);
+    if (ec) {
+        throw std::runtime_error("WAL dizini oluşturulamadı: " + config.directory + ": " + ec.message());
+    }
+}
+
+WriteAheadLog::~WriteAheadLog() {
+    if (log_fd >= 0) {
+        if (unsynced_batches > 0) {
+            ::fdatasync(log_fd);
+        }
+        ::close(log_fd);
+    }
+}
+
+std::string WriteAheadLog::path_of(const char* prefix, uint64_t height, const char* suffix) const {
+    char name[64];
+    std::snprintf(name, sizeof(name), "%s%020llu%s", prefix,
+                  static_cast<unsigned long long>(height), suffix);
+    return (std::filesystem::path(config.directory) / name).string();
+}
+
+void WriteAheadLog::write_all(int fd, const uint8_t* data, size_t len) {
+    while (len > 0) {
+        ssize_t n = ::write(fd, data, len);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error(std::string("WAL yazılamadı: ") + std::strerror(errno));
+        }
+        data += n;
+        len -= static_cast<size_t>(n);
+    }
+}
+
+void WriteAheadLog::sync_directory() {
+    int fd = ::open(config.directory.c_str(), O_RDONLY | O_DIRECTORY);
+    if (fd < 0) {
+        throw std::runtime_error(std::string("WAL dizini açılamadı: ") + std::strerror(errno));
+    }
+    ::fsync(fd);
+    ::close(fd);
+}
+
+void WriteAheadLog::open_segment(uint64_t base) {
+    if (log_fd >= 0) {
+        ::close(log_fd);
+    }
+    
+    std::string path = path_of("wal-", base, ".log");
+    log_fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (log_fd < 0) {
+        throw std::runtime_error("WAL segmenti açılamadı: " + path + ": " + std::strerror(errno));
+    }
+    segment_base = base;
+    unsynced_batches = 0;
+    
+    // Yeni dosyanın dizin girdisi de kalıcı olmalı
+    sync_directory();
+}
+
+WalRecoveryResult WriteAheadLog::recover(FractalSharding& sharding) {
+    namespace fs = std::filesystem;
+    WalRecoveryResult result;
+    
+    std::vector<uint64_t> checkpoints;
+    std::vector<uint64_t> segments;
+    for (const auto& entry : fs::directory_iterator(config.directory)) {
+        std::string name = entry.path().filename().string();
+        uint64_t height;
+        if (parse_height(name, "checkpoint-", ".bin", height)) {
+            checkpoints.push_back(height);
+        } else if (parse_height(name, "wal-", ".log", height)) {
+            segments.push_back(height);
+        } else if (name.size() > 4 && name.compare(name.size() - 4, 4, ".tmp") == 0) {
+            // Yarım kalmış checkpoint
+            std::error_code ec;
+            fs::remove(entry.path(), ec);
+        }
+    }
+    std::sort(checkpoints.rbegin(), checkpoints.rend());
+    std::sort(segments.begin(), segments.end());
+    
+    // 1) En yeni geçerli checkpoint
+    uint64_t height = 0;
+    for (uint64_t candidate : checkpoints) {
+        std::vector<std::pair<Address, uint64_t>> balances;
+        uint64_t stored;
+        if (load_checkpoint(path_of("checkpoint-", candidate, ".bin"), stored, balances) &&
+            stored == candidate) {
+            sharding.restore_balances(balances);
+            height = candidate;
+            result.checkpoint_height = candidate;
+            result.accounts_restored = balances.size();
+            break;
+        }
+    }
+    
+    // 2) Log kayıtlarını sırayla uygula; ilk bozuk kayıtta dur ve kuyruğu kes.
+    // Yeni kayıtlar okunan son segmentin sonuna eklenir.
+    std::vector<std::pair<Address, uint64_t>> changes;
+    uint64_t tail_segment = height;
+    for (size_t s = 0; s < segments.size() && !result.torn_tail; ++s) {
+        std::string path = path_of("wal-", segments[s], ".log");
+        tail_segment = segments[s];
+        std::vector<uint8_t> data;
+        if (!read_file(path, data)) {
+            continue;
+        }
+        
+        size_t at = 0;
+        while (at < data.size()) {
+            size_t record = at;
+            uint32_t magic, payload;
+            uint64_t record_height;
+            uint32_t count, crc;
+            
+            bool valid = get(data, at, magic) && magic == WAL_RECORD_MAGIC &&
+                         get(data, at, payload) && payload >= 12 &&
+                         payload <= data.size() - at && data.size() - at - payload >= 4;
+            if (valid) {
+                size_t body = at;
+                at += payload;
+                valid = get(data, at, crc) && crc == crc32c(data.data() + body, payload);
+                at = body;
+                valid = valid && get(data, at, record_height) && get(data, at, count) &&
+                        static_cast<size_t>(count) * WAL_ENTRY_SIZE == payload - 12;
+            }
+            
+            if (!valid) {
+                // Çökmede yarım kalan yazım: buradan sonrası hiç commit edilmedi
+                result.torn_tail = true;
+                if (::truncate(path.c_str(), static_cast<off_t>(record)) != 0) {
+                    throw std::runtime_error("WAL kesilemedi: " + path + ": " + std::strerror(errno));
+                }
+                for (size_t later = s + 1; later < segments.size(); ++later) {
+                    std::error_code ec;
+                    fs::remove(path_of("wal-", segments[later], ".log"), ec);
+                }
+                break;
+            }
+            
+            if (record_height > height) {
+                changes.clear();
+                changes.reserve(count);
+                for (uint32_t e = 0; e < count; ++e) {
+                    Address addr;
+                    uint64_t balance;
+                    std::memcpy(addr.data(), data.data() + at, 20);
+                    std::memcpy(&balance, data.data() + at + 20, 8);
+                    changes.emplace_back(addr, balance);
+                    at += WAL_ENTRY_SIZE;
+                }
+                sharding.restore_balances(changes);
+                height = record_height;
+                ++result.records_replayed;
+            } else {
+                at += static_cast<size_t>(count) * WAL_ENTRY_SIZE;
+            }
+            at += 4;
+        }
+    }
+    
+    result.recovered_height = height;
+    last_height = height;
+    last_checkpoint = result.checkpoint_height;
+    open_segment(tail_segment);
+    return result;
+}
+
+void WriteAheadLog::append(uint64_t height, const std::vector<std::pair<Address, uint64_t>>& changes) {
+    if (height <= last_height) {
+        return;
+    }
+    if (log_fd < 0) {
+        open_segment(last_height);
+    }
+    
+    buffer.clear();
+    buffer.reserve(WAL_HEADER_SIZE + 12 + changes.size() * WAL_ENTRY_SIZE + 4);
+    put(buffer, WAL_RECORD_MAGIC);
+    put(buffer, static_cast<uint32_t>(12 + changes.size() * WAL_ENTRY_SIZE));
+    put(buffer, height);
+    put(buffer, static_cast<uint32_t>(changes.size()));
+    for (const auto& [addr, balance] : changes) {
+        put_entry(buffer, addr, balance);
+    }
+    put(buffer, crc32c(buffer.data() + WAL_HEADER_SIZE, buffer.size() - WAL_HEADER_SIZE));
+    
+    // Batch'in tamamı tek write(); fdatasync grup halinde
+    write_all(log_fd, buffer.data(), buffer.size());
+    bytes.fetch_add(buffer.size(), std::memory_order_relaxed);
+    last_height = height;
+    
+    if (++unsynced_batches >= config.fsync_every_batches) {
+        sync();
+    }
+}
+
+void WriteAheadLog::sync() {
+    if (log_fd < 0 || unsynced_batches == 0) {
+        return;
+    }
+    if (::fdatasync(log_fd) != 0) {
+        throw std::runtime_error(std::string("WAL fdatasync başarısız: ") + std::strerror(errno));
+    }
+    fsyncs.fetch_add(1, std::memory_order_relaxed);
+    unsynced_batches = 0;
+}
+
+bool WriteAheadLog::checkpoint_due(uint64_t height) const {
+    return config.checkpoint_every_batches != 0 &&
+           height >= last_checkpoint + config.checkpoint_every_batches;
+}
+
+void WriteAheadLog::checkpoint(const StateSnapshot& snapshot) {
+    namespace fs = std::filesystem;
+    
+    // Log'da görüntüden yeni kayıt varsa onları silmek veri kaybı olur
+    if (snapshot.height < last_height) {
+        return;
+    }
+    
+    std::string final_path = path_of("checkpoint-", snapshot.height, ".bin");
+    std::string tmp_path = final_path + ".tmp";
+    int fd = ::open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        throw std::runtime_error("Checkpoint açılamadı: " + tmp_path + ": " + std::strerror(errno));
+    }
+    
+    std::vector<uint8_t> out;
+    put(out, CHECKPOINT_MAGIC);
+    put(out, snapshot.height);
+    put(out, SHARD_COUNT);
+    put(out, crc32c(out.data(), out.size()));
+    write_all(fd, out.data(), out.size());
+    
+    // Shard başına bağımsız doğrulanabilir bölüm
+    for (const auto& shard : snapshot.shards) {
+        out.clear();
+        put(out, shard->shard_id);
+        put(out, static_cast<uint64_t>(shard->account_count));
+        for (const auto& bucket : shard->buckets) {
+            for (const auto& [addr, balance] : *bucket) {
+                put_entry(out, addr, balance);
+            }
+        }
+        put(out, crc32c(out.data(), out.size()));
+        write_all(fd, out.data(), out.size());
+    }
+    
+    if (::fsync(fd) != 0) {
+        int err = errno;
+        ::close(fd);
+        throw std::runtime_error(std::string("Checkpoint fsync başarısız: ") + std::strerror(err));
+    }
+    ::close(fd);
+    
+    if (::rename(tmp_path.c_str(), final_path.c_str()) != 0) {
+        throw std::runtime_error("Checkpoint yerine konamadı: " + final_path + ": " + std::strerror(errno));
+    }
+    sync_directory();
+    
+    // Checkpoint kalıcı: yeni segment aç, eskileri sil
+    open_segment(snapshot.height);
+    last_checkpoint = snapshot.height;
+    last_height = snapshot.height;
+    
+    for (const auto& entry : fs::directory_iterator(config.directory)) {
+        std::string name = entry.path().filename().string();
+        uint64_t height;
+        if ((parse_height(name, "wal-", ".log", height) && height < snapshot.height) ||
+            (parse_height(name, "checkpoint-", ".bin", height) && height < snapshot.height)) {
+            std::error_code ec;
+            fs::remove(entry.path(), ec);
+        }
+    }
+}
+
+} // namespace HyperLayer
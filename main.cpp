@@ -4,6 +4,7 @@
 #include "hyperlayer_core.hpp"
 #include <iostream>
 #include <iomanip>
+#include <sstream>
 #include <thread>
 #include <chrono>
 #include <vector>
@@ -46,6 +47,50 @@ void print_feature(const std::string& name, const std::string& status) {
               << GREEN << "[" << status << "]" << RESET << std::endl;
 }
 
+// Regresyon: her bayt konumu hash'i değiştirmeli. Eski hash j % 8 >= 4
+// konumlarını hiç okumuyordu ve aynı şeritteki iki fark (d, rotl(d, 7))
+// birbirini sıfırlıyordu. Bozulursa demo hata koduyla çıkar.
+size_t check_hash_byte_coverage(QuantumCrypto& crypto) {
+    std::mt19937_64 rng(40);
+    size_t checked = 0;
+    
+    for (size_t len : {1, 8, 31, 64, 65, 128, 200}) {
+        std::vector<uint8_t> input(len);
+        for (auto& b : input) {
+            b = static_cast<uint8_t>(rng());
+        }
+        Hash256 base = crypto.hash(input.data(), input.size());
+        
+        for (size_t j = 0; j < len; ++j) {
+            for (uint8_t flip : {uint8_t(0x01), uint8_t(0x80)}) {
+                input[j] ^= flip;
+                bool differs = crypto.hash(input.data(), input.size()) != base;
+                input[j] ^= flip;
+                if (!differs) {
+                    throw std::runtime_error("hash " + std::to_string(j) + ". baytı yok sayıyor (len " +
+                                             std::to_string(len) + ")");
+                }
+                ++checked;
+            }
+            
+            // Aynı şeritte döndürmeyle birbirini sıfırlayan fark çifti
+            if (j + 8 < len && (j % 64) + 8 < 64) {
+                input[j] ^= 0x01;
+                input[j + 8] ^= 0x80;
+                bool differs = crypto.hash(input.data(), input.size()) != base;
+                input[j] ^= 0x01;
+                input[j + 8] ^= 0x80;
+                if (!differs) {
+                    throw std::runtime_error("hash " + std::to_string(j) + "/" + std::to_string(j + 8) +
+                                             ". bayt farkları birbirini sıfırlıyor");
+                }
+                ++checked;
+            }
+        }
+    }
+    return checked;
+}
+
 void demo_quantum_crypto() {
     std::cout << BOLD << MAGENTA << "\n[1] QUANTUM-READY KRİPTOGRAFİ TESTİ" << RESET << std::endl;
     print_separator();
@@ -58,11 +103,9 @@ void demo_quantum_crypto() {
     crypto.generate_keypair(pub, priv);
     
     std::cout << "  ✓ Post-Quantum Keypair oluşturuldu" << std::endl;
-    std::cout << "    Public Key (ilk 16 byte): ";
-    for (int i = 0; i < 16; ++i) {
-        std::cout << std::hex << std::setw(2) << std::setfill('0') << (int)pub[i];
-    }
-    std::cout << "..." << std::dec << std::endl;
+    char hex[32];
+    hex_encode(pub.data(), 16, hex);
+    std::cout << "    Public Key (ilk 16 byte): " << std::string_view(hex, 32) << "..." << std::endl;
     
     // Signing
     std::string message = "HyperLayer Protocol - Devrimsel Layer 3";
@@ -82,11 +125,10 @@ void demo_quantum_crypto() {
     // Hash test
     Hash256 hash = crypto.hash((const uint8_t*)message.data(), message.size());
     std::cout << "  ✓ Quantum-resistant hash hesaplandı" << std::endl;
-    std::cout << "    Hash: ";
-    for (int i = 0; i < 8; ++i) {
-        std::cout << std::hex << std::setw(2) << std::setfill('0') << (int)hash[i];
-    }
-    std::cout << "..." << std::dec << std::endl;
+    std::cout << "    Hash: " << HexHash(hash).prefix(16) << "..." << std::endl;
+    
+    size_t variants = check_hash_byte_coverage(crypto);
+    std::cout << "  ✓ Hash bayt kapsamı: " << variants << " tek/çift bayt farkı, hepsi farklı hash" << std::endl;
 }
 
 void demo_dag_structure() {
@@ -177,9 +219,35 @@ void demo_adaptive_consensus() {
     
     if (consensus_reached) {
         std::cout << GREEN << "  ✓ Konsensüs sağlandı (BFT 2/3+1 majority)" << RESET << std::endl;
+        
+        // Light client: tek transaction için Merkle inclusion proof
+        MerkleProof proof = consensus.get_inclusion_proof(3);
+        bool included = BatchMerkleTree::verify(test_txs[3].compute_hash(crypto), proof,
+                                                consensus.get_last_batch_root());
+        std::cout << "  ✓ Batch Merkle kökü: " << HexHash(consensus.get_last_batch_root()).prefix(16)
+                  << "..." << std::endl;
+        std::cout << "  " << (included ? GREEN "✓" : RED "✗") << " Inclusion proof (TX #4, "
+                  << proof.siblings.size() << " kardeş hash)" << RESET << std::endl;
     } else {
         std::cout << RED << "  ✗ Konsensüs sağlanamadı" << RESET << std::endl;
     }
+    
+    // Discrete-event simülasyon: 21 validator, 20 batch, 20ms link gecikmesi
+    SimulationConfig sim_config;
+    sim_config.batch_count = 20;
+    
+    ConsensusSimulator simulator(sim_config);
+    SimulationReport sim = simulator.run();
+    
+    std::cout << "\n  Konsensüs Simülasyonu (" << sim_config.node_count << " node, "
+              << sim_config.batch_size << " tx/batch):" << std::endl;
+    std::cout << "    Commit edilen batch: " << CYAN << sim.committed_batches << RESET << std::endl;
+    // Biçim yerel akışta kalır; cout'un hassasiyeti sonraki demolara sızmaz
+    std::ostringstream latency;
+    latency << std::fixed << std::setprecision(1) << sim.latency_p50_ms << " / " << sim.latency_p99_ms;
+    std::cout << "    Commit gecikmesi p50/p99: " << CYAN << latency.str() << " ms" << RESET << std::endl;
+    std::cout << "    Throughput: " << CYAN << static_cast<uint64_t>(sim.throughput_tps) << " TPS"
+              << RESET << std::endl;
 }
 
 void demo_fractal_sharding() {
@@ -190,6 +258,8 @@ void demo_fractal_sharding() {
     QuantumCrypto crypto;
     
     std::cout << "  Toplam Shard Sayısı: " << CYAN << SHARD_COUNT << RESET << std::endl;
+    std::cout << "  Aktif Shard (yüke göre bölünür/birleşir): " << CYAN
+              << sharding.active_shard_count() << RESET << std::endl;
     
     // Create test addresses
     std::random_device rd;
@@ -298,7 +368,7 @@ void demo_cross_chain_bridge() {
     std::cout << "\n  Test: Bitcoin → HyperLayer Transfer" << std::endl;
     Hash256 transfer_id = bridge.initiate_transfer(btc_tx);
     std::cout << GREEN << "    ✓ Transfer başlatıldı" << RESET << std::endl;
-    std::cout << "    Transfer ID: " << hash_to_string(transfer_id).substr(0, 16) << "..." << std::endl;
+    std::cout << "    Transfer ID: " << HexHash(transfer_id).prefix(16) << "..." << std::endl;
     
     // Simulate validator signatures
     std::vector<Signature> validator_sigs;
@@ -0,0 +1,380 @@
+// mock_chain_server.cpp
+// HyperLayer Protocol - Yerel zincir RPC taklidi (test ve benchmark için)
+//
+// Bitcoin, Ethereum ve Solana düğümlerinin işlem getirme çağrılarını hazır
+// (canned) işlemlerle yanıtlar; CrossChainBridge adaptörleri gerçek bir
+// düğüm yerine buna bağlanabilir. Tek port, tüm zincirler:
+//
+//   getrawtransaction ["<hex>"]                       -> "<ham işlem hex>"
+//   eth_getRawTransactionByHash ["0x<hex>"]           -> "0x<ham işlem hex>"
+//   getTransaction ["<hex>", {"encoding":"base64"}]   -> {"slot":i,"transaction":["<base64>","base64"]}
+//   mock_listTransactions ["bitcoin"|"ethereum"|"solana"] -> hash listesi (hex, sırayla)
+//   mock_shutdown []                                  -> true, sunucu kapanır
+//
+// Zincir başına --count işlem vardır. i'nci işlem: from[k] = i*131 + k,
+// to[k] = i*17 + 3k (mod 256), amount = 1000 + i; Bitcoin/Ethereum yerleşimi
+// from(20) | to(20) | amount(8), Solana'da hesaplar 32 bayta sıfırla
+// doldurulur. İşlem hash'i ham baytların QuantumCrypto::hash'idir.
+//
+// HTTP/1.1 keep-alive, pipelining ve JSON-RPC batch desteklenir. Her istek
+// alındıktan --latency-ms sonra yanıtlanır (ağ + düğüm gecikmesi taklidi);
+// aynı bağlantıdaki pipelined istekler birbirini beklemez, yanıtlar geliş
+// sırasıyla yazılır. --port 0 ile boş bir port seçilir; dinlenen adres ilk
+// satırda yazdırılır.
+
+#include "hyperlayer_core.hpp"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <cctype>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace HyperLayer;
+
+namespace {
+
+struct CannedChain {
+    std::string name;
+    std::vector<Hash256> hashes;
+    std::vector<std::vector<uint8_t>> raw;
+    std::unordered_map<Hash256, size_t, ArrayHash> index;
+};
+
+CannedChain make_chain(const std::string& name, size_t count, size_t account_size) {
+    QuantumCrypto crypto;
+    CannedChain chain;
+    chain.name = name;
+    for (size_t i = 0; i < count; ++i) {
+        std::vector<uint8_t> raw(2 * account_size + 8, 0);
+        for (size_t k = 0; k < 20; ++k) {
+            raw[k] = static_cast<uint8_t>(i * 131 + k);
+            raw[account_size + k] = static_cast<uint8_t>(i * 17 + 3 * k);
+        }
+        uint64_t amount = 1000 + i;
+        std::memcpy(raw.data() + 2 * account_size, &amount, 8);
+        
+        Hash256 hash = crypto.hash(raw.data(), raw.size());
+        chain.index[hash] = i;
+        chain.hashes.push_back(hash);
+        chain.raw.push_back(std::move(raw));
+    }
+    return chain;
+}
+
+struct MockServer {
+    CannedChain bitcoin;
+    CannedChain ethereum;
+    CannedChain solana;
+    std::chrono::microseconds latency;
+    int listen_fd;
+    std::atomic<bool> stopping;
+    
+    MockServer() : latency(0), listen_fd(-1), stopping(false) {}
+};
+
+// params dizisinin ilk öğesi (dizge), "0x" öneki atılmış
+bool first_param(std::string_view params, std::string& out) {
+    bool found = false;
+    json_for_each_element(params, [&](std::string_view element) {
+        found = json_string_value(element, out);
+        return false;
+    });
+    if (found && out.compare(0, 2, "0x") == 0) {
+        out.erase(0, 2);
+    }
+    return found;
+}
+
+const std::vector<uint8_t>* lookup(const CannedChain& chain, std::string_view params, size_t& index) {
+    std::string hex;
+    Hash256 hash;
+    if (!first_param(params, hex) || !HexHash::parse(hex, hash)) {
+        return nullptr;
+    }
+    auto it = chain.index.find(hash);
+    if (it == chain.index.end()) {
+        return nullptr;
+    }
+    index = it->second;
+    return &chain.raw[index];
+}
+
+std::string hex_string(const std::vector<uint8_t>& bytes, const char* prefix) {
+    std::string out(prefix);
+    size_t start = out.size();
+    out.resize(start + 2 * bytes.size());
+    hex_encode(bytes.data(), bytes.size(), &out[start]);
+    return "\"" + out + "\"";
+}
+
+// Tek bir JSON-RPC çağrısının yanıt nesnesi; bildirimlere (id'siz) de yanıt verilir
+std::string handle_call(MockServer& server, std::string_view call) {
+    std::string id = "null";
+    std::string method;
+    std::string_view params = "[]";
+    bool valid = json_for_each_member(call, [&](std::string_view key, std::string_view value) {
+        if (key == "id") {
+            id = std::string(value);
+        } else if (key == "method") {
+            json_string_value(value, method);
+        } else if (key == "params") {
+            params = value;
+        }
+        return true;
+    });
+    
+    auto result = [&](const std::string& value) {
+        return "{\"jsonrpc\":\"2.0\",\"id\":" + id + ",\"result\":" + value + "}";
+    };
+    auto error = [&](int code, const std::string& message) {
+        return "{\"jsonrpc\":\"2.0\",\"id\":" + id + ",\"error\":{\"code\":" + std::to_string(code) +
+               ",\"message\":\"" + message + "\"}}";
+    };
+    if (!valid || method.empty()) {
+        return error(-32600, "Invalid Request");
+    }
+    
+    size_t index = 0;
+    if (method == "getrawtransaction") {
+        const auto* raw = lookup(server.bitcoin, params, index);
+        return raw ? result(hex_string(*raw, "")) : error(-5, "No such mempool or blockchain transaction");
+    }
+    if (method == "eth_getRawTransactionByHash") {
+        const auto* raw = lookup(server.ethereum, params, index);
+        return result(raw ? hex_string(*raw, "0x") : "null");
+    }
+    if (method == "getTransaction") {
+        const auto* raw = lookup(server.solana, params, index);
+        if (!raw) {
+            return result("null");
+        }
+        return result("{\"slot\":" + std::to_string(index) + ",\"transaction\":[\"" +
+                      base64_encode(raw->data(), raw->size()) + "\",\"base64\"],\"meta\":null}");
+    }
+    if (method == "mock_listTransactions") {
+        std::string name;
+        first_param(params, name);
+        const CannedChain* chain = name == "bitcoin" ? &server.bitcoin :
+                                   name == "ethereum" ? &server.ethereum :
+                                   name == "solana" ? &server.solana : nullptr;
+        if (!chain) {
+            return error(-32602, "Invalid params");
+        }
+        std::string list = "[";
+        for (size_t i = 0; i < chain->hashes.size(); ++i) {
+            list += i ? ",\"" : "\"";
+            list += HexHash(chain->hashes[i]).str();
+            list += "\"";
+        }
+        return result(list + "]");
+    }
+    if (method == "mock_shutdown") {
+        server.stopping.store(true);
+        return result("true");
+    }
+    return error(-32601, "Method not found");
+}
+
+std::string handle_body(MockServer& server, std::string_view body) {
+    size_t first = body.find_first_not_of(" \t\r\n");
+    if (first == std::string_view::npos || body[first] != '[') {
+        return handle_call(server, body);
+    }
+    std::string out = "[";
+    bool valid = json_for_each_element(body, [&](std::string_view call) {
+        out += out.size() > 1 ? "," : "";
+        out += handle_call(server, call);
+        return true;
+    });
+    if (!valid) {
+        return "{\"jsonrpc\":\"2.0\",\"id\":null,\"error\":{\"code\":-32700,\"message\":\"Parse error\"}}";
+    }
+    return out + "]";
+}
+
+// Bağlantı: okuyucu istekleri hemen işler, yazıcı her yanıtı vadesinde ve sırayla gönderir
+void serve_connection(MockServer& server, int fd) {
+    struct Reply {
+        std::chrono::steady_clock::time_point due;
+        std::string bytes;
+        bool shutdown;
+    };
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::deque<Reply> replies;
+    bool reader_done = false;
+    
+    std::thread writer([&]() {
+        while (true) {
+            Reply reply;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                ready.wait(lock, [&]() { return !replies.empty() || reader_done; });
+                if (replies.empty()) {
+                    return;
+                }
+                reply = std::move(replies.front());
+                replies.pop_front();
+            }
+            std::this_thread::sleep_until(reply.due);
+            size_t sent = 0;
+            while (sent < reply.bytes.size()) {
+                ssize_t n = ::send(fd, reply.bytes.data() + sent, reply.bytes.size() - sent, MSG_NOSIGNAL);
+                if (n < 0 && errno == EINTR) {
+                    continue;
+                }
+                if (n <= 0) {
+                    break;
+                }
+                sent += static_cast<size_t>(n);
+            }
+            if (reply.shutdown) {
+                // accept() hata döner, ana döngü biter
+                ::shutdown(server.listen_fd, SHUT_RDWR);
+            }
+        }
+    });
+    
+    std::string buffer;
+    char chunk[16384];
+    bool open = true;
+    while (open) {
+        size_t header_end;
+        while ((header_end = buffer.find("\r\n\r\n")) == std::string::npos) {
+            ssize_t n = ::recv(fd, chunk, sizeof(chunk), 0);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                open = false;
+                break;
+            }
+            buffer.append(chunk, static_cast<size_t>(n));
+        }
+        if (!open) {
+            break;
+        }
+        auto received = std::chrono::steady_clock::now();
+        
+        std::string head = buffer.substr(0, header_end);
+        for (auto& c : head) {
+            c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        }
+        size_t length_at = head.find("\r\ncontent-length:");
+        size_t length = length_at == std::string::npos ? 0 : std::strtoull(head.c_str() + length_at + 17, nullptr, 10);
+        while (buffer.size() < header_end + 4 + length) {
+            ssize_t n = ::recv(fd, chunk, sizeof(chunk), 0);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                open = false;
+                break;
+            }
+            buffer.append(chunk, static_cast<size_t>(n));
+        }
+        if (!open) {
+            break;
+        }
+        std::string body = buffer.substr(header_end + 4, length);
+        buffer.erase(0, header_end + 4 + length);
+        
+        bool shutdown_requested = !server.stopping.load();
+        std::string response = handle_body(server, body);
+        shutdown_requested = shutdown_requested && server.stopping.load();
+        std::string bytes = "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nContent-Length: " +
+                            std::to_string(response.size()) + "\r\n\r\n" + response;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            replies.push_back(Reply{received + server.latency, std::move(bytes), shutdown_requested});
+        }
+        ready.notify_one();
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        reader_done = true;
+    }
+    ready.notify_one();
+    writer.join();
+    ::close(fd);
+}
+
+void usage(const char* program) {
+    std::cerr << "Kullanım: " << program << " [--port N] [--count N] [--latency-ms X]" << std::endl;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    uint16_t port = 18443;
+    size_t count = 1000;
+    double latency_ms = 2.0;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            usage(argv[0]);
+            return 2;
+        }
+        if (arg == "--port") {
+            port = static_cast<uint16_t>(std::atoi(argv[++i]));
+        } else if (arg == "--count") {
+            count = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--latency-ms") {
+            latency_ms = std::atof(argv[++i]);
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    
+    MockServer server;
+    server.bitcoin = make_chain("bitcoin", count, 20);
+    server.ethereum = make_chain("ethereum", count, 20);
+    server.solana = make_chain("solana", count, 32);
+    server.latency = std::chrono::microseconds(static_cast<int64_t>(latency_ms * 1000.0));
+    
+    server.listen_fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    int one = 1;
+    ::setsockopt(server.listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (::bind(server.listen_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        ::listen(server.listen_fd, 128) != 0) {
+        std::cerr << "mock_chain_server: 127.0.0.1:" << port << " dinlenemedi: " << std::strerror(errno) << std::endl;
+        return 1;
+    }
+    socklen_t addr_len = sizeof(addr);
+    ::getsockname(server.listen_fd, reinterpret_cast<sockaddr*>(&addr), &addr_len);
+    std::cout << "mock_chain_server listening on http://127.0.0.1:" << ntohs(addr.sin_port)
+              << " (" << count << " tx per chain, " << latency_ms << " ms latency)" << std::endl;
+    
+    while (!server.stopping.load()) {
+        int fd = ::accept4(server.listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        std::thread(serve_connection, std::ref(server), fd).detach();
+    }
+    ::close(server.listen_fd);
+    return 0;
+}